@@ -0,0 +1,48 @@
+#include "vector.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <time.h>
+
+// unique elements through hashing against merge sorting then dropping adjacent duplicates
+
+const CmpState cmp_int(const void* const a, const void* const b){
+    const int x = *(const int*)a, y = *(const int*)b;
+    if ( x < y ) return inf;
+    if ( x == y ) return eq;
+    return sup;
+}
+
+double seconds(){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+int main(){
+    const u64 n = 10000000;
+    const int ranges[] = { 16, 1000, 100000, 10000000 };
+    vec_err err = no_err;
+    srand(42);
+    fprintf(stdout, "%10s %10s %12s %12s\n", "elements", "distinct", "hash (s)", "sort (s)");
+    for ( u64 r = 0; r < sizeof(ranges) / sizeof(*ranges); r++ ){
+        Vector v = vec_init_(sizeof(int), 0, &err);
+        for ( u64 i = 0; i < n; i++ ){
+            const int x = rand() % ranges[r];
+            vec_push_(v, &x, &err);
+        }
+        double start = seconds();
+        Vector hashed = vec_unique(v, NULL, NULL, NULL, &err);
+        const double hashing = seconds() - start;
+        start = seconds();
+        Vector sorted = vec_stable_sort_(v, cmp_int, &err);
+        vec_dedup_sorted(sorted, cmp_int, &err);
+        const double sorting = seconds() - start;
+        fprintf(stdout, "%10" PRIu64 " %10" PRIu64 " %12.3f %12.3f\n", n, vec_len(hashed, &err), hashing, sorting);
+        if ( vec_len(hashed, &err) != vec_len(sorted, &err) ) fprintf(stderr, "mismatch\n");
+        vec_destroy(sorted, &err);
+        vec_destroy(hashed, &err);
+        vec_destroy(v, &err);
+    }
+    return 0;
+}
@@ -1,5 +1,7 @@
 #include "vector.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
 
 void print_int(const int x){ fprintf(stdout, "%d", x); }
 void print_float(const float x){ fprintf(stdout, "%f", x); }
@@ -13,9 +15,385 @@ const int multiply10(int x){ return x*10; }
 
 const float div10(int x){ return ((float)x)/10.0; }
 
+const CmpState cmp_int_(const void* const a, const void* const b){
+    return cmp_int(*(const int*)a, *(const int*)b);
+}
+
+#define POINT(X, S) X(S, float, x) X(S, float, y) X(S, int, id)
+GENERIC_SOA(point, POINT)
+
+const CmpState cmp_float(const float a, const float b){
+    if ( a < b ) return inf;
+    if ( a == b ) return eq;
+    return sup;
+}
+const int even_id(const point_row row){ return row.id % 2 == 0; }
+void triple(const void* const x, void* const out){ *(int*)out = *(const int*)x * 3; }
+const int odd(const void* const x){ return *(const int*)x & 1; }
+u64 hash_mod(const void* const x, void* const ctx){ return (u64)( *(const int*)x % *(const int*)ctx ); }
+int eq_mod(const void* const a, const void* const b, void* const ctx){
+    return *(const int*)a % *(const int*)ctx == *(const int*)b % *(const int*)ctx;
+}
+
 #define vpi(v) do { vec_print_int(v, print_int); } while(0);
 #define vpf(v) do { vec_print_float(v, print_float); } while(0);
 
+static const int* ints(cVector v){
+    vec_err err;
+    return (const int*)vec_cdata_(v, &err);
+}
+
+static Vector ints_from(const int* const xs, const u64 n){
+    vec_err err;
+    Vector v = vec_init_(sizeof(int), n, &err);
+    for ( u64 i = 0; i < n; i++ ) vec_push_(v, xs + i, &err);
+    return v;
+}
+
+// build both test.c and vector.c with -DVEC_STATS for the counters to move
+static void test_stats(void){
+    vec_err err;
+    const int xs[] = { 5, 3, 9, 1 };
+    Vector v = ints_from(xs, 4);
+    const int x = 7;
+    vec_insert_(v, &x, 1, &err);
+    free(vec_remove_(v, 0, &err));
+    Vector sorted = vec_sort_(v, cmp_int_, &err);
+    const vec_stats st = vec_stats_of(v, &err);
+#ifdef VEC_STATS
+    assert(st.allocs >= 2 && st.bytes_moved > 0);
+    assert(st.sorts == 1 && st.comparisons > 0);
+    assert(st.peak_bytes >= 4 * sizeof(int));
+    assert(vec_stats_global().sorts >= 1);
+#else
+    assert(st.allocs == 0 && st.reallocs == 0 && st.bytes_copied == 0 && st.bytes_moved == 0);
+    assert(st.comparisons == 0 && st.sorts == 0 && st.peak_bytes == 0);
+#endif
+    vec_destroy(sorted, &err);
+    vec_destroy(v, &err);
+}
+
+static void test_aligned(void){
+    vec_err err;
+    assert(vec_init_aligned_(sizeof(int), 0, 48, &err) == NULL && err == illegal_align_err);
+    const u64 alignments[] = { 0, 64, 4096, 8192 };
+    for ( u64 a = 0; a < sizeof(alignments) / sizeof(*alignments); a++ ){
+        const u64 alignment = alignments[a] != 0 ? alignments[a] : VEC_CACHE_LINE;
+        Vector v = vec_init_aligned_(sizeof(int), 0, alignments[a], &err);
+        assert(err == no_err);
+        // grows well past VEC_HUGE_THRESHOLD, mapped then remapped for alignments up to the page size
+        for ( int i = 0; i < 3000000; i++ ){
+            vec_push_(v, &i, &err);
+            assert(err == no_err);
+            if ( ( i & ( i - 1 ) ) == 0 ) assert((u64)ints(v) % alignment == 0);
+        }
+        assert((u64)ints(v) % alignment == 0);
+        for ( int i = 0; i < 3000000; i += 997 ) assert(ints(v)[i] == i);
+        Vector copy = vec_clone(v, &err);
+        assert((u64)ints(copy) % alignment == 0 && ints(copy)[2999999] == 2999999);
+        vec_destroy(copy, &err);
+        vec_destroy(v, &err);
+    }
+}
+
+static void test_gap_vector(void){
+    vec_err err;
+    GapVector g = gvec_init_(sizeof(int), 0, &err);
+    for ( int i = 0; i < 100; i++ ) gvec_push_(g, &i, &err);
+    for ( int i = 0; i < 50; i++ ){
+        const int x = 1000 + i;
+        gvec_insert_(g, &x, 2 * i, &err);
+    }
+    assert(gvec_len(g, &err) == 150);
+    for ( int i = 49; i >= 0; i-- ){
+        int* const removed = (int*)gvec_remove_(g, 2 * i, &err);
+        assert(*removed == 1000 + i);
+        free(removed);
+    }
+    Vector v = gvec_into_vec(g, &err);
+    assert(vec_len(v, &err) == 100);
+    for ( int i = 0; i < 100; i++ ) assert(ints(v)[i] == i);
+    vec_destroy(v, &err);
+}
+
+static void test_fset_insert_many(void){
+    vec_err err;
+    for ( int layout = 0; layout < 2; layout++ ){
+        FlatSet s = fset_init_(sizeof(int), 0, cmp_int_, layout ? fset_eytzinger : fset_sorted, &err);
+        Vector batch = vec_init_(sizeof(int), 0, &err);
+        for ( int i = 0; i < 100000; i++ ){
+            const int x = 2 * i;
+            vec_push_(batch, &x, &err);
+        }
+        assert(fset_insert_many_(s, batch, &err) == 100000 && err == no_err);
+        vec_destroy(batch, &err);
+        const int dup[] = { 7, 3, 7, 4, 3, 199998, 200001, 200001 };
+        batch = ints_from(dup, 8);
+        assert(fset_insert_many_(s, batch, &err) == 3);
+        vec_destroy(batch, &err);
+        assert(fset_len(s, &err) == 100003);
+        const int* const items = (const int*)vec_cdata_(fset_items(s, &err), &err);
+        for ( u64 i = 1; i < fset_len(s, &err); i++ ) assert(items[i - 1] < items[i]);
+        const int present = 7, absent = 5;
+        assert(fset_find_(s, &present, &err) < fset_len(s, &err));
+        assert(fset_find_(s, &absent, &err) == fset_len(s, &err));
+        fset_destroy(s, &err);
+    }
+}
+
+static void test_heaps(void){
+    GENERIC_VEC(int)
+    vec_err err;
+    enum{ N = 2000 };
+    int xs[N];
+    srand(30);
+    for ( int i = 0; i < N; i++ ) xs[i] = rand() % 500;
+    const u64 arities[] = { 2, 4 };
+    for ( u64 a = 0; a < 2; a++ ){
+        const u64 arity = arities[a];
+        // generic, half from make_heap and half pushed, then popped in non increasing order
+        Vector v = ints_from(xs, N / 2);
+        vec_make_heap(v, cmp_int_, arity, &err);
+        for ( int i = N / 2; i < N; i++ ) vec_heap_push(v, xs + i, cmp_int_, arity, &err);
+        int top, last = 500;
+        const int small = -1;
+        vec_heap_replace_top(v, &small, &top, cmp_int_, arity, &err);
+        assert(err == no_err);
+        for ( int i = 0; i < N; i++ ){
+            int x;
+            vec_heap_pop_into(v, &x, cmp_int_, arity, &err);
+            assert(err == no_err && x <= last);
+            last = x;
+        }
+        assert(last == -1 && vec_len(v, &err) == 0);
+        vec_heap_pop_into(v, &top, cmp_int_, arity, &err);
+        assert(err == illegal_del_err);
+        vec_destroy(v, &err);
+        // typed, same sequence
+        v = ints_from(xs, N / 2);
+        vec_make_heap_int(v, cmp_int, arity, &err);
+        for ( int i = N / 2; i < N; i++ ) vec_heap_push_int(v, xs[i], cmp_int, arity, &err);
+        assert(vec_heap_replace_top_int(v, -1, cmp_int, arity, &err) == top);
+        last = 500;
+        for ( int i = 0; i < N; i++ ){
+            const int x = vec_heap_pop_int(v, cmp_int, arity, &err);
+            assert(err == no_err && x <= last);
+            last = x;
+        }
+        assert(last == -1);
+        vec_destroy(v, &err);
+    }
+}
+
+static void test_soa(void){
+    vec_err err;
+    enum{ N = 1000 };
+    point_soa s = soa_init_point(0, &err);
+    for ( int i = 0; i < N; i++ )
+        soa_push_point(s, (point_row){ (float)( i * 37 % 100 ), (float)i, i }, &err);
+    assert(soa_len_point(s, &err) == N);
+    const point_row r = soa_get_point(s, 10, &err);
+    assert(r.x == 70.0f && r.y == 10.0f && r.id == 10);
+    soa_get_point(s, N, &err);
+    assert(err == index_out_of_bounds_err);
+
+    assert(soa_sum_point_id(s, &err) == N * ( N - 1 ) / 2);
+    assert(soa_min_point_id(s, &err) == 0 && soa_max_point_id(s, &err) == N - 1);
+    assert(soa_min_point_x(s, &err) == 0.0f && soa_max_point_x(s, &err) == 99.0f);
+
+    // stable on x, every column follows
+    soa_sort_by_point_x(s, cmp_float, &err);
+    assert(err == no_err);
+    for ( u64 i = 0; i < N; i++ ){
+        const point_row row = soa_get_point(s, i, &err);
+        assert(row.y == (float)row.id && row.x == (float)( row.id * 37 % 100 ));
+        if ( i == 0 ) continue;
+        const point_row prev = soa_get_point(s, i - 1, &err);
+        assert(prev.x < row.x || ( prev.x == row.x && prev.id < row.id ));
+    }
+
+    point_soa evens = soa_filter_point(s, even_id, &err);
+    assert(soa_len_point(evens, &err) == N / 2);
+    for ( u64 i = 0; i < N / 2; i++ ) assert(soa_get_point(evens, i, &err).id % 2 == 0);
+    soa_destroy_point(evens, &err);
+
+    Vector rows = soa_to_vec_point(s, &err);
+    assert(vec_len(rows, &err) == N);
+    point_soa back = soa_from_vec_point(rows, &err);
+    for ( u64 i = 0; i < N; i++ ){
+        const point_row a = soa_get_point(s, i, &err), b = soa_get_point(back, i, &err);
+        const point_row c = ((const point_row*)vec_cdata_(rows, &err))[i];
+        assert(a.x == b.x && a.y == b.y && a.id == b.id && a.id == c.id && a.x == c.x);
+    }
+    soa_destroy_point(back, &err);
+    vec_destroy(rows, &err);
+    soa_destroy_point(s, &err);
+}
+
+static void test_pipelines(void){
+    vec_err err;
+    Vector v = vec_init_(sizeof(int), 0, &err);
+    for ( int i = 0; i < 10000; i++ ) vec_push_(v, &i, &err);
+    for ( int filtered = 0; filtered < 2; filtered++ ){
+        Pipeline p = pipe_from_(v, &err);
+        pipe_map_(p, sizeof(int), triple, &err);
+        if ( filtered ) pipe_filter_(p, odd, &err);
+        Vector serial = pipe_collect_(p, &err);
+        Vector parallel = pipe_collect_par_(p, 4, &err);
+        assert(vec_len(serial, &err) == vec_len(parallel, &err));
+        for ( u64 i = 0; i < vec_len(serial, &err); i++ ) assert(ints(serial)[i] == ints(parallel)[i]);
+        vec_destroy(serial, &err);
+        vec_destroy(parallel, &err);
+        pipe_destroy(p, &err);
+    }
+    // a source shortened after the pipeline was built is read up to its new length
+    Pipeline p = pipe_from_range_(v, 100, 9000, &err);
+    vec_truncate(v, 500, &err);
+    Vector out = pipe_collect_(p, &err);
+    assert(vec_len(out, &err) == 400 && ints(out)[399] == 499);
+    vec_destroy(out, &err);
+    pipe_destroy(p, &err);
+    vec_destroy(v, &err);
+}
+
+static void test_copy_on_write(void){
+    vec_err err;
+    const int xs[] = { 1, 2, 3, 4 };
+    for ( int order = 0; order < 2; order++ ){
+        Vector a = ints_from(xs, 4);
+        Vector b = vec_share(a, &err);
+        assert(err == no_err && ints(a) == ints(b));
+        int* const data = (int*)vec_data_(b, &err);
+        data[0] = 100;
+        assert(ints(a)[0] == 1 && ints(b)[0] == 100);
+        const int x = 5;
+        vec_push_(a, &x, &err);
+        assert(vec_len(a, &err) == 5 && vec_len(b, &err) == 4);
+        Vector c = vec_share(a, &err);
+        if ( order == 0 ){
+            vec_destroy(a, &err);
+            assert(ints(c)[4] == 5);
+            vec_destroy(c, &err);
+        }
+        else{
+            vec_destroy(c, &err);
+            assert(ints(a)[4] == 5);
+            vec_destroy(a, &err);
+        }
+        assert(ints(b)[3] == 4);
+        vec_destroy(b, &err);
+    }
+}
+
+static void test_apply_permutation(void){
+    vec_err err;
+    const int xs[] = { 10, 20, 30, 40, 50 };
+    const u64 order[] = { 4, 0, 3, 1, 2 };
+    Vector v = ints_from(xs, 5);
+    Vector perm = vec_init_(sizeof(u64), 5, &err);
+    for ( int i = 0; i < 5; i++ ) vec_push_(perm, order + i, &err);
+    vec_apply_permutation(v, perm, &err);
+    assert(err == no_err);
+    for ( int i = 0; i < 5; i++ ) assert(ints(v)[i] == xs[order[i]]);
+    vec_destroy(perm, &err);
+    const u64 twice[] = { 4, 4, 3, 1, 2 };
+    perm = vec_init_(sizeof(u64), 5, &err);
+    for ( int i = 0; i < 5; i++ ) vec_push_(perm, twice + i, &err);
+    vec_apply_permutation(v, perm, &err);
+    assert(err == index_out_of_bounds_err && ints(v)[0] == 50);
+    vec_destroy(perm, &err);
+    vec_destroy(v, &err);
+}
+
+static void test_selection(void){
+    GENERIC_VEC(int)
+    vec_err err;
+    enum{ N = 1000 };
+    for ( int equal = 0; equal < 2; equal++ ){
+        int xs[N];
+        for ( int i = 0; i < N; i++ ) xs[i] = equal ? 42 : i;
+        Vector v = ints_from(xs, N);
+        vec_nth_element(v, N / 3, cmp_int_, &err);
+        assert(err == no_err && ints(v)[N / 3] == xs[N / 3]);
+        vec_destroy(v, &err);
+        v = ints_from(xs, N);
+        vec_partial_sort(v, 10, cmp_int_, &err);
+        for ( int i = 0; i < 10; i++ ) assert(ints(v)[i] == xs[i]);
+        vec_destroy(v, &err);
+        v = ints_from(xs, N);
+        Vector top = vec_top_k(v, 10, cmp_int_, &err);
+        assert(vec_len(top, &err) == 10);
+        for ( int i = 0; i < 10; i++ ) assert(ints(top)[i] == xs[N - 1 - i]);
+        vec_destroy(top, &err);
+        top = vec_top_k_int(v, 10, cmp_int, &err);
+        for ( int i = 0; i < 10; i++ ) assert(ints(top)[i] == xs[N - 1 - i]);
+        vec_destroy(top, &err);
+        vec_partial_sort_int(v, 10, cmp_int, &err);
+        for ( int i = 0; i < 10; i++ ) assert(ints(v)[i] == xs[i]);
+        vec_nth_element_int(v, N / 2, cmp_int, &err);
+        assert(ints(v)[N / 2] == xs[N / 2]);
+        vec_destroy(v, &err);
+    }
+}
+
+static void test_dedup(void){
+    vec_err err;
+    const int xs[] = { 4, 1, 4, 7, 1, 1, 9, 4, 12 };
+    Vector v = ints_from(xs, 9);
+
+    // bytes, first appearances in order
+    Vector u = vec_unique(v, NULL, NULL, NULL, &err);
+    const int unique[] = { 4, 1, 7, 9, 12 };
+    assert(err == no_err && vec_len(u, &err) == 5);
+    for ( int i = 0; i < 5; i++ ) assert(ints(u)[i] == unique[i]);
+    vec_destroy(u, &err);
+
+    // user hash and equality through ctx, equal modulo 3
+    int modulo = 3;
+    u = vec_unique(v, hash_mod, eq_mod, &modulo, &err);
+    assert(vec_len(u, &err) == 2 && ints(u)[0] == 4 && ints(u)[1] == 9);
+    vec_destroy(u, &err);
+
+    Vector counts, ids;
+    Vector firsts = vec_group_by(v, NULL, NULL, NULL, &counts, &ids, &err);
+    const u64 first[] = { 0, 1, 3, 6, 8 }, count[] = { 3, 3, 1, 1, 1 }, id[] = { 0, 1, 0, 2, 1, 1, 3, 0, 4 };
+    assert(err == no_err && vec_len(firsts, &err) == 5 && vec_len(counts, &err) == 5 && vec_len(ids, &err) == 9);
+    for ( int g = 0; g < 5; g++ ){
+        assert(((const u64*)vec_cdata_(firsts, &err))[g] == first[g]);
+        assert(((const u64*)vec_cdata_(counts, &err))[g] == count[g]);
+    }
+    for ( int i = 0; i < 9; i++ ) assert(((const u64*)vec_cdata_(ids, &err))[i] == id[i]);
+    vec_destroy(firsts, &err);
+    vec_destroy(counts, &err);
+    vec_destroy(ids, &err);
+
+    firsts = vec_group_by(v, hash_mod, eq_mod, &modulo, NULL, &ids, &err);
+    assert(err == no_err && vec_len(firsts, &err) == 2);
+    for ( int i = 0; i < 9; i++ ) assert(((const u64*)vec_cdata_(ids, &err))[i] == (u64)( xs[i] % 3 == 0 ));
+    vec_destroy(firsts, &err);
+    vec_destroy(ids, &err);
+    firsts = vec_group_by(v, NULL, NULL, NULL, &counts, NULL, &err);
+    assert(err == no_err && vec_len(counts, &err) == 5);
+    vec_destroy(firsts, &err);
+    vec_destroy(counts, &err);
+    firsts = vec_group_by(v, NULL, NULL, NULL, NULL, NULL, &err);
+    assert(err == no_err && vec_len(firsts, &err) == 5);
+    vec_destroy(firsts, &err);
+
+    // adjacent duplicates, by cmp and by bytes
+    Vector sorted = vec_stable_sort_(v, cmp_int_, &err);
+    Vector shared = vec_share(sorted, &err);
+    vec_dedup_sorted(sorted, cmp_int_, &err);
+    assert(err == no_err && vec_len(sorted, &err) == 5 && vec_len(shared, &err) == 9);
+    const int ordered[] = { 1, 4, 7, 9, 12 };
+    for ( int i = 0; i < 5; i++ ) assert(ints(sorted)[i] == ordered[i]);
+    vec_dedup_sorted(shared, NULL, &err);
+    assert(vec_len(shared, &err) == 5 && ints(shared)[4] == 12);
+    vec_destroy(shared, &err);
+    vec_destroy(sorted, &err);
+    vec_destroy(v, &err);
+}
+
 int main(){
     GENERIC_VEC(int)
     GENERIC_VEC(float)
@@ -32,5 +410,17 @@ int main(){
     vpi(v_int);
     vec_destroy(v_float, &err);
     vec_destroy(v_int, &err);
+    test_stats();
+    test_aligned();
+    test_gap_vector();
+    test_fset_insert_many();
+    test_heaps();
+    test_soa();
+    test_pipelines();
+    test_copy_on_write();
+    test_apply_permutation();
+    test_selection();
+    test_dedup();
+    fprintf(stdout, "\nall tests passed\n");
     return 0; 
 }
@@ -1,4 +1,5 @@
 
+#define _GNU_SOURCE
 #include "vector.h"
 
 
@@ -6,6 +7,18 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <inttypes.h>
+#include <pthread.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// arrays of aligned vectors at least this big are mmap'd and advised to huge pages
+#ifndef VEC_HUGE_THRESHOLD
+#define VEC_HUGE_THRESHOLD (1UL << 21)
+#endif
 
 
 
@@ -14,13 +27,267 @@ struct vector{
     u64    length;
     u64    capacity;
     u64    element_size;
+    u64    alignment;       // 0 for plain malloc'd storage
+    u64    mapped;          // size of the mapping when the array is mmap'd, 0 otherwise
+    u64*   refs;            // handles sharing the array after vec_share, NULL when not shared
+#ifdef VEC_STATS
+    vec_stats stats;
+#endif
+};
+
+/*
+ *  a gap vector keeps its elements in buf.array around a hole [gap_begin, gap_end) that follows the last edit,
+ *  buf.length is unused, the number of elements is buf.capacity - ( gap_end - gap_begin )
+ */
+struct gap_vector{
+    struct vector buf;
+    u64    gap_begin;
+    u64    gap_end;
+};
+
+/*
+ *  a flat set keeps its elements sorted and unique in items, with read mostly sets the eytzinger layout
+ *  keeps a breadth first copy of them in eytz[1..length] together with their sorted index, rebuilt by
+ *  every modification so that searches never write, NULL when it could not be allocated
+ */
+struct flat_set{
+    Vector      items;
+    const CmpState(* cmp)(const void* const, const void* const);
+    fset_layout layout;
+    void*       eytz;
+    u64*        eytz_index;
+};
+
+/*
+ *  a pipeline reads [begin, end) of either a Vector ( read through source at run time ) or a raw view in data,
+ *  end is clamped to the length of source when running. stages only records what to do, they are all applied
+ *  element by element in a single pass when collecting
+ */
+typedef enum{
+    pipe_map,
+    pipe_filter,
+    pipe_take,
+    pipe_zip,
+} pipe_kind;
+
+struct pipe_stage{
+    pipe_kind kind;
+    u64       element_size;     // size of the elements leaving the stage
+    void      (* map)(const void* const, void* const);
+    int       (* filter)(const void* const);
+    void      (* zip)(const void* const, const void* const, void* const);
+    cVector   other;
+    u64       n;
+};
+
+struct pipeline{
+    const void* data;
+    Vector      source;
+    u64         begin;
+    u64         end;
+    u64         element_size;
+    Vector      stages;
 };
 
 enum{
     VECSIZE = sizeof(struct vector),
+    PIPESIZE = sizeof(struct pipeline),
+    FSETSIZE = sizeof(struct flat_set),
+    GAPVECSIZE = sizeof(struct gap_vector),
     VOIDPTRSIZE = sizeof(void*),
 };
 
+#ifdef VEC_STATS
+
+static vec_stats g_stats;
+
+static inline void in_stat_peak(cVector v){
+    const u64 bytes = v -> capacity * v -> element_size;
+    if ( bytes > v -> stats.peak_bytes )
+        v -> stats.peak_bytes = bytes;
+    u64 seen = __atomic_load_n(&g_stats.peak_bytes, __ATOMIC_RELAXED);
+    while ( bytes > seen && !__atomic_compare_exchange_n(
+                &g_stats.peak_bytes, &seen, bytes, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED) );
+}
+
+// counts on v and on the global counters
+#define VEC_STAT(v, field, n)                                                   \
+    do{                                                                         \
+        (v) -> stats.field += (n);                                              \
+        __atomic_fetch_add(&g_stats.field, (n), __ATOMIC_RELAXED);              \
+    }while(0)
+// counts on a local tally, later merged with VEC_STAT
+#define VEC_TALLY(t, field, n)  do{ (t) -> field += (n); }while(0)
+#define VEC_STAT_INIT(v)        do{ memset(&(v) -> stats, 0, sizeof(vec_stats)); }while(0)
+#define VEC_STAT_PEAK(v)        in_stat_peak(v)
+
+#else
+
+#define VEC_STAT(v, field, n)   do{ }while(0)
+#define VEC_TALLY(t, field, n)  ((void)(t))
+#define VEC_STAT_INIT(v)        do{ }while(0)
+#define VEC_STAT_PEAK(v)        do{ }while(0)
+
+#endif
+
+
+/*
+ *  storage of the array
+ *  plain vectors live on malloc/realloc, aligned ones on aligned_alloc and are copied on growth
+ *  since realloc would not keep the alignment, and past VEC_HUGE_THRESHOLD they move to an
+ *  anonymous mapping advised to huge pages that grows in place or without copy through mremap
+ */
+
+static inline u64 in_round_up(const u64 x, const u64 to){
+    return ( x + to - 1 ) / to * to;
+}
+
+static inline int in_arr_wants_map(cVector v, const u64 bytes){
+#ifdef __linux__
+    return v -> alignment != 0
+        && bytes >= VEC_HUGE_THRESHOLD
+        && v -> alignment <= (u64)sysconf(_SC_PAGESIZE);
+#else
+    (void)v; (void)bytes;
+    return 0;
+#endif
+}
+
+static void* in_arr_map(cVector v, const u64 bytes){
+#ifdef __linux__
+    const u64 len = in_round_up(bytes, VEC_HUGE_THRESHOLD);
+    void* out = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if ( out == MAP_FAILED ) return NULL;
+    madvise(out, len, MADV_HUGEPAGE);
+    v -> mapped = len;
+    return out;
+#else
+    (void)v; (void)bytes;
+    return NULL;
+#endif
+}
+
+// allocates the array of v for its current capacity
+static void* in_arr_alloc(cVector v){
+    const u64 bytes = v -> capacity * v -> element_size;
+    v -> mapped = 0;
+    if ( v -> alignment == 0 )
+        return malloc(bytes);
+    if ( in_arr_wants_map(v, bytes) )
+        return in_arr_map(v, bytes);
+    return aligned_alloc(v -> alignment, in_round_up(bytes != 0 ? bytes : 1, v -> alignment));
+}
+
+static void in_arr_free(cVector v){
+#ifdef __linux__
+    if ( v -> mapped != 0 ){
+        munmap(v -> array, v -> mapped);
+        return;
+    }
+#endif
+    free(v -> array);
+}
+
+// resizes the array of v to hold capacity elements, the array is left untouched on failure
+static int in_arr_resize(cVector v, const u64 capacity){
+    const u64 bytes = capacity * v -> element_size;
+    void* out;
+    if ( v -> alignment == 0 ){
+        out = realloc(v -> array, bytes);
+        if ( out == NULL ) return -1;
+        goto done;
+    }
+#ifdef __linux__
+    if ( v -> mapped != 0 ){
+        if ( bytes > v -> mapped ){
+            const u64 len = in_round_up(bytes, VEC_HUGE_THRESHOLD);
+            out = mremap(v -> array, v -> mapped, len, MREMAP_MAYMOVE);
+            if ( out == MAP_FAILED ) return -1;
+            madvise(out, len, MADV_HUGEPAGE);
+            v -> mapped = len;
+            goto done;
+        }
+        out = v -> array;
+        goto done;
+    }
+#endif
+    const u64 old_mapped = v -> mapped;
+    out = in_arr_wants_map(v, bytes)
+        ? in_arr_map(v, bytes)
+        : aligned_alloc(v -> alignment, in_round_up(bytes != 0 ? bytes : 1, v -> alignment));
+    if ( out == NULL ){
+        v -> mapped = old_mapped;
+        return -1;
+    }
+    memcpy(out, v -> array, v -> length * v -> element_size);
+    free(v -> array);
+    VEC_STAT(v, allocs, 1);
+    VEC_STAT(v, bytes_copied, v -> length * v -> element_size);
+done:
+    v -> array = out;
+    v -> capacity = capacity;
+    VEC_STAT(v, reallocs, 1);
+    VEC_STAT_PEAK(v);
+    return 0;
+}
+
+/*
+ *  copy on write
+ *  vec_share hands out handles on the same array counted by refs, any write through a handle first gives
+ *  it its own copy, the last one to let go of the shared array frees it. lengths stay per handle so that
+ *  popping or truncating a shared vector does not copy. sharing only reads v besides installing refs with a
+ *  compare and swap, so that several threads may share the same vector as long as none writes through it
+ */
+static int in_vec_unshare(cVector v, vec_err* __restrict const err){
+    if ( __atomic_load_n(v -> refs, __ATOMIC_ACQUIRE) == 1 ){
+        free(v -> refs);
+        v -> refs = NULL;
+        return 0;
+    }
+    struct vector copy = *v;
+    copy.array = in_arr_alloc(&copy);
+    if ( copy.array == NULL ){
+        *err = alloc_err;
+        return -1;
+    }
+    memcpy(copy.array, v -> array, v -> length * v -> element_size);
+    VEC_STAT(v, allocs, 1);
+    VEC_STAT(v, bytes_copied, v -> length * v -> element_size);
+    VEC_STAT_PEAK(v);
+    if ( __atomic_sub_fetch(v -> refs, 1, __ATOMIC_ACQ_REL) == 0 ){
+        in_arr_free(v);
+        free(v -> refs);
+    }
+    v -> array = copy.array;
+    v -> mapped = copy.mapped;
+    v -> refs = NULL;
+    return 0;
+}
+
+// to call before writing to the array of v, non zero when the copy failed
+static inline int in_vec_own(cVector v, vec_err* __restrict const err){
+    if ( v -> refs == NULL ) return 0;
+    return in_vec_unshare(v, err);
+}
+
+// releases the array of v unless other handles still share it
+static inline void in_vec_release(cVector v){
+    if ( v -> refs != NULL ){
+        if ( __atomic_sub_fetch(v -> refs, 1, __ATOMIC_ACQ_REL) != 0 ) return;
+        free(v -> refs);
+    }
+    in_arr_free(v);
+}
+
+// doubles the capacity of v
+static inline void in_vec_grow(cVector v, vec_err* __restrict const err){
+    if ( in_arr_resize(v, v -> capacity != 0 ? v -> capacity * 2 : 10) != 0 ){
+        *err = realloc_err;
+        return;
+    }
+    *err = no_err;
+}
+
 Vector vec_init_(
         u64 element_size,
         u64 def_capa,
@@ -29,11 +296,17 @@ Vector vec_init_(
     Vector v = (Vector)malloc(VECSIZE);
     if ( v == NULL )
         goto exit_failure_outer;
+    v -> length = 0;
+    VEC_STAT_INIT(v);
     v -> capacity = def_capa != 0 ? def_capa : 10;
     v -> element_size = element_size;
-    v -> array = malloc(element_size * v -> capacity);
+    v -> alignment = 0;
+    v -> refs = NULL;
+    v -> array = in_arr_alloc(v);
     if ( v -> array == NULL )
         goto exit_failure_inner;
+    VEC_STAT(v, allocs, 2);
+    VEC_STAT_PEAK(v);
     *err = no_err;
     return v;
 exit_failure_inner:
@@ -52,11 +325,17 @@ static inline Vector in_vec_init(
     Vector v = (Vector)malloc(VECSIZE);
     if ( v == NULL )
         goto in_exit_failure_outer;
+    v -> length = 0;
+    VEC_STAT_INIT(v);
     v -> capacity = def_capa != 0 ? def_capa : 10;
     v -> element_size = element_size;
-    v -> array = malloc(element_size * v -> capacity);
+    v -> alignment = 0;
+    v -> refs = NULL;
+    v -> array = in_arr_alloc(v);
     if ( v -> array == NULL )
         goto in_exit_failure_inner;
+    VEC_STAT(v, allocs, 2);
+    VEC_STAT_PEAK(v);
     *err = no_err;
     return v;
 in_exit_failure_inner:
@@ -66,6 +345,41 @@ in_exit_failure_outer:
     return NULL;
 }
 
+Vector vec_init_aligned_(
+        u64 element_size,
+        u64 def_capa,
+        u64 alignment,
+        vec_err* __restrict const err
+){
+    if ( alignment == 0 )
+        alignment = VEC_CACHE_LINE;
+    if ( ( alignment & ( alignment - 1 ) ) != 0 ){
+        *err = illegal_align_err;
+        return NULL;
+    }
+    Vector v = (Vector)malloc(VECSIZE);
+    if ( v == NULL )
+        goto aligned_exit_failure_outer;
+    v -> length = 0;
+    VEC_STAT_INIT(v);
+    v -> capacity = def_capa != 0 ? def_capa : 10;
+    v -> element_size = element_size;
+    v -> alignment = alignment;
+    v -> refs = NULL;
+    v -> array = in_arr_alloc(v);
+    if ( v -> array == NULL )
+        goto aligned_exit_failure_inner;
+    VEC_STAT(v, allocs, 2);
+    VEC_STAT_PEAK(v);
+    *err = no_err;
+    return v;
+aligned_exit_failure_inner:
+    free(v);
+aligned_exit_failure_outer:
+    *err = alloc_err;
+    return NULL;
+}
+
 
 
 void vec_destroy(Vector v, vec_err* __restrict const err ){
@@ -78,7 +392,7 @@ void vec_destroy(Vector v, vec_err* __restrict const err ){
         *err = null_vec_err;
         return;
     }
-    free(v->array);
+    in_vec_release(v);
     free(v);
     *err = no_err;
 }
@@ -94,7 +408,7 @@ static inline void in_vec_destroy(Vector v, vec_err* __restrict const err ){
         *err = null_vec_err;
         return;
     }
-    free(v->array);
+    in_vec_release(v);
     free(v);
     *err = no_err;
 }
@@ -104,22 +418,19 @@ void vec_push_(
     const void* const element,
     vec_err* __restrict const err
 ){
+    if ( in_vec_own(v, err) != 0 )
+        return;
     if ( v -> length == v -> capacity ){
-        v -> capacity *= 2;
-        v -> array = realloc(
-                v -> array,
-                v -> capacity * v -> element_size
-        );
-        if ( v -> array == NULL ){
-            *err = realloc_err;
+        in_vec_grow(v, err);
+        if ( *err != no_err )
             return;
-        }
     }
     memcpy( 
         v -> array + ( v -> length * v -> element_size ),
         element,
         v -> element_size
     );
+    VEC_STAT(v, bytes_copied, v -> element_size);
     v -> length ++;
     *err = no_err; 
 }
@@ -129,22 +440,19 @@ static inline void in_vec_push(
     const void* const element,
     vec_err* __restrict const err
 ){
+    if ( in_vec_own(v, err) != 0 )
+        return;
     if ( v -> length == v -> capacity ){
-        v -> capacity *= 2;
-        v -> array = realloc(
-                v -> array,
-                v -> capacity * v -> element_size
-        );
-        if ( v -> array == NULL ){
-            *err = realloc_err;
+        in_vec_grow(v, err);
+        if ( *err != no_err )
             return;
-        }
     }
     memcpy( 
         v -> array + ( v -> length * v -> element_size ),
         element,
         v -> element_size
     );
+    VEC_STAT(v, bytes_copied, v -> element_size);
     v -> length ++;
     *err = no_err; 
 }
@@ -214,6 +522,8 @@ void* vec_pop_(cVector const v, vec_err* __restrict err){
             v -> array + (v -> element_size * ( -- v -> length )),
             v -> element_size
     );
+    VEC_STAT(v, allocs, 1);
+    VEC_STAT(v, bytes_copied, v -> element_size);
     *err = no_err;
     return out;
 }
@@ -236,16 +546,12 @@ void vec_insert_(
         *err = index_out_of_bounds_err;
         return;
     }
+    if ( in_vec_own(v, err) != 0 )
+        return;
     if ( v -> length == v -> capacity ){
-        v -> capacity *= 2;
-        v -> array = realloc(
-            v -> array,
-            v -> capacity * v -> element_size
-        );
-        if ( v -> array == NULL ){
-            *err = realloc_err;
-            return ;
-        }
+        in_vec_grow(v, err);
+        if ( *err != no_err )
+            return;
     }
     memmove(
         v -> array + (index+1) * v -> element_size,
@@ -257,6 +563,8 @@ void vec_insert_(
         element,
         v -> element_size
     );  
+    VEC_STAT(v, bytes_moved, v -> element_size * (v -> length - index));
+    VEC_STAT(v, bytes_copied, v -> element_size);
     v -> length ++;
     *err = no_err;
 }
@@ -282,6 +590,8 @@ void* vec_remove_(
         *err = index_out_of_bounds_err;
         return NULL;
     }
+    if ( in_vec_own(v, err) != 0 )
+        return NULL;
     void* out = malloc(v -> element_size);
     if ( out == NULL ){
         *err = alloc_err;
@@ -295,8 +605,11 @@ void* vec_remove_(
     memmove(
         v -> array + (index * v -> element_size),
         v -> array + (index + 1) * v -> element_size,
-        v -> element_size * ( v -> length - index )
+        v -> element_size * ( v -> length - index - 1 )
     );
+    VEC_STAT(v, allocs, 1);
+    VEC_STAT(v, bytes_copied, v -> element_size);
+    VEC_STAT(v, bytes_moved, v -> element_size * ( v -> length - index - 1 ));
     v -> length --;
     *err = no_err;
     return out;
@@ -333,6 +646,8 @@ void* vec_get_(
         v -> array + v -> element_size * index,
         v -> element_size
     );
+    VEC_STAT(v, allocs, 1);
+    VEC_STAT(v, bytes_copied, v -> element_size);
     *err = no_err;
     return out;
 }
@@ -369,6 +684,8 @@ static inline void* in_vec_get(
         v -> array + v -> element_size * index,
         v -> element_size
     );
+    VEC_STAT(v, allocs, 1);
+    VEC_STAT(v, bytes_copied, v -> element_size);
     *err = no_err;
     return out;
 }
@@ -589,7 +906,8 @@ static void quick_sort(
         const CmpState(* const cmp)(
             const void* const,
             const void* const
-        )
+        ),
+        vec_stats* const tally
         ){
     if (length < 2) return;
 
@@ -598,9 +916,12 @@ static void quick_sort(
     u64 i, j;
 
     for (i = 0, j = 0; j < length - 1; j++) {
+        VEC_TALLY(tally, comparisons, 1);
         if (cmp(dest + j * element_size, pivot) <= 0) {
             if (i != j) {
                 // Swap elements if necessary
+                VEC_TALLY(tally, allocs, 1);
+                VEC_TALLY(tally, bytes_copied, 3 * element_size);
                 void* temp = malloc(element_size);
                 memcpy(temp, dest + i * element_size, element_size);
                 memcpy(dest + i * element_size, dest + j * element_size, element_size);
@@ -613,6 +934,8 @@ static void quick_sort(
 
     // Swap the pivot into the correct place
     if (i != length - 1) {
+        VEC_TALLY(tally, allocs, 1);
+        VEC_TALLY(tally, bytes_copied, 3 * element_size);
         void* temp = malloc(element_size);
         memcpy(temp, (char*)dest + i * element_size, element_size);
         memcpy((char*)dest + i * element_size, pivot, element_size);
@@ -621,8 +944,8 @@ static void quick_sort(
     }
 
     // Recursively sort the partitions
-    quick_sort(dest, i, element_size, cmp);
-    quick_sort(dest + (i + 1) * element_size, length - i - 1, element_size, cmp);
+    quick_sort(dest, i, element_size, cmp, tally);
+    quick_sort(dest + (i + 1) * element_size, length - i - 1, element_size, cmp, tally);
 }
 
 
@@ -647,9 +970,15 @@ Vector vec_sort_(
 
     memcpy(out->array, v->array, v->length * v->element_size);
     out->length = v->length;
+    VEC_STAT(v, bytes_copied, v -> length * v -> element_size);
 
     // Perform quick sort on the copied array
-    quick_sort(out->array, out->length, out->element_size, cmp);
+    vec_stats tally = { 0 };
+    quick_sort(out->array, out->length, out->element_size, cmp, &tally);
+    VEC_STAT(v, sorts, 1);
+    VEC_STAT(v, comparisons, tally.comparisons);
+    VEC_STAT(v, allocs, tally.allocs);
+    VEC_STAT(v, bytes_copied, tally.bytes_copied);
 
     *err = no_err;
     return out; 
@@ -679,6 +1008,8 @@ void vec_panic(const vec_err err){
             handle_err("illegal access Error!");
         case index_out_of_bounds_err:
             handle_err("Index out of Bounds Error!");
+        case illegal_align_err:
+            handle_err("illegal alignment Error!");
         default:
             handle_err("Unkown Error!");
     }
@@ -710,3 +1041,2161 @@ void vec_print_(
     printer(v -> array + v -> element_size * ( v -> length - 1 ));
     printf(">");
 }
+
+
+
+vec_stats vec_stats_of(
+        __restrict const cVector v,
+        vec_err* __restrict const err
+        ){
+    vec_stats out = { 0 };
+    if ( v == NULL ){
+        *err = null_vec_err;
+        return out;
+    }
+#ifdef VEC_STATS
+    out = v -> stats;
+#endif
+    *err = no_err;
+    return out;
+}
+
+vec_stats vec_stats_global(void){
+    vec_stats out = { 0 };
+#ifdef VEC_STATS
+    out.allocs       = __atomic_load_n(&g_stats.allocs,       __ATOMIC_RELAXED);
+    out.reallocs     = __atomic_load_n(&g_stats.reallocs,     __ATOMIC_RELAXED);
+    out.bytes_copied = __atomic_load_n(&g_stats.bytes_copied, __ATOMIC_RELAXED);
+    out.bytes_moved  = __atomic_load_n(&g_stats.bytes_moved,  __ATOMIC_RELAXED);
+    out.comparisons  = __atomic_load_n(&g_stats.comparisons,  __ATOMIC_RELAXED);
+    out.sorts        = __atomic_load_n(&g_stats.sorts,        __ATOMIC_RELAXED);
+    out.peak_bytes   = __atomic_load_n(&g_stats.peak_bytes,   __ATOMIC_RELAXED);
+#endif
+    return out;
+}
+
+void vec_stats_reset(
+        cVector v,
+        vec_err* __restrict const err
+        ){
+    if ( v == NULL ){
+        *err = null_vec_err;
+        return;
+    }
+    VEC_STAT_INIT(v);
+    VEC_STAT_PEAK(v);
+    *err = no_err;
+}
+
+void vec_stats_reset_global(void){
+#ifdef VEC_STATS
+    memset(&g_stats, 0, sizeof(vec_stats));
+#endif
+}
+
+static void in_stats_print(const vec_stats* const st){
+    fprintf(stderr,
+            "allocs: %" PRIu64 ", reallocs: %" PRIu64 ", bytes copied: %" PRIu64 ", bytes moved: %" PRIu64 ", "
+            "comparisons: %" PRIu64 ", sorts: %" PRIu64 ", peak bytes: %" PRIu64 "\n",
+            st -> allocs, st -> reallocs, st -> bytes_copied, st -> bytes_moved,
+            st -> comparisons, st -> sorts, st -> peak_bytes
+    );
+}
+
+void vec_stats_print(const __restrict cVector v){
+    if ( v == NULL ){
+        fprintf(stderr, "(nullvec)\n");
+        return;
+    }
+    vec_err err;
+    const vec_stats st = vec_stats_of(v, &err);
+    in_stats_print(&st);
+}
+
+void vec_stats_dump(void){
+    const vec_stats st = vec_stats_global();
+    fprintf(stderr, "[vec_stats] ");
+    in_stats_print(&st);
+}
+
+void vec_stats_dump_at_exit(void){
+    static int registered = 0;
+    if ( registered ) return;
+    registered = 1;
+    atexit(vec_stats_dump);
+}
+
+
+
+static inline u64 in_gvec_len(const struct gap_vector* const g){
+    return g -> buf.capacity - ( g -> gap_end - g -> gap_begin );
+}
+
+static inline void* in_gvec_at(const struct gap_vector* const g, const u64 index){
+    const u64 physical = index < g -> gap_begin ? index : index + ( g -> gap_end - g -> gap_begin );
+    return g -> buf.array + physical * g -> buf.element_size;
+}
+
+// slides the gap so that it starts at index, moving only the elements in between
+static void in_gvec_move_gap(struct gap_vector* const g, const u64 index){
+    const u64 es = g -> buf.element_size;
+    if ( index < g -> gap_begin ){
+        const u64 n = g -> gap_begin - index;
+        memmove(
+            g -> buf.array + ( g -> gap_end - n ) * es,
+            g -> buf.array + index * es,
+            n * es
+        );
+        g -> gap_begin -= n;
+        g -> gap_end -= n;
+        VEC_STAT(&g -> buf, bytes_moved, n * es);
+    }
+    else if ( index > g -> gap_begin ){
+        const u64 n = index - g -> gap_begin;
+        memmove(
+            g -> buf.array + g -> gap_begin * es,
+            g -> buf.array + g -> gap_end * es,
+            n * es
+        );
+        g -> gap_begin += n;
+        g -> gap_end += n;
+        VEC_STAT(&g -> buf, bytes_moved, n * es);
+    }
+}
+
+// doubles the capacity, the new room goes to the gap
+static void in_gvec_grow(struct gap_vector* const g, vec_err* __restrict const err){
+    const u64 es = g -> buf.element_size;
+    const u64 tail = g -> buf.capacity - g -> gap_end;
+    struct vector grown = g -> buf;
+    grown.capacity = g -> buf.capacity != 0 ? g -> buf.capacity * 2 : 10;
+    grown.array = in_arr_alloc(&grown);
+    if ( grown.array == NULL ){
+        *err = realloc_err;
+        return;
+    }
+    memcpy(grown.array, g -> buf.array, g -> gap_begin * es);
+    memcpy(
+        grown.array + ( grown.capacity - tail ) * es,
+        g -> buf.array + g -> gap_end * es,
+        tail * es
+    );
+    in_arr_free(&g -> buf);
+    g -> buf = grown;
+    g -> gap_end = grown.capacity - tail;
+    VEC_STAT(&g -> buf, reallocs, 1);
+    VEC_STAT(&g -> buf, bytes_copied, ( g -> gap_begin + tail ) * es);
+    VEC_STAT_PEAK(&g -> buf);
+    *err = no_err;
+}
+
+GapVector gvec_init_(
+        u64 element_size,
+        u64 def_capa,
+        vec_err* __restrict const err
+        ){
+    GapVector g = (GapVector)malloc(GAPVECSIZE);
+    if ( g == NULL ){
+        *err = alloc_err;
+        return NULL;
+    }
+    g -> buf.length = 0;
+    VEC_STAT_INIT(&g -> buf);
+    g -> buf.capacity = def_capa != 0 ? def_capa : 10;
+    g -> buf.element_size = element_size;
+    g -> buf.alignment = 0;
+    g -> buf.refs = NULL;
+    g -> buf.array = in_arr_alloc(&g -> buf);
+    if ( g -> buf.array == NULL ){
+        free(g);
+        *err = alloc_err;
+        return NULL;
+    }
+    g -> gap_begin = 0;
+    g -> gap_end = g -> buf.capacity;
+    VEC_STAT(&g -> buf, allocs, 2);
+    VEC_STAT_PEAK(&g -> buf);
+    *err = no_err;
+    return g;
+}
+
+GapVector gvec_from_vec(
+        Vector v,
+        vec_err* __restrict const err
+        ){
+    if ( v == NULL || v -> array == NULL ){
+        *err = null_vec_err;
+        return NULL;
+    }
+    if ( in_vec_own(v, err) != 0 )
+        return NULL;
+    GapVector g = (GapVector)malloc(GAPVECSIZE);
+    if ( g == NULL ){
+        *err = alloc_err;
+        return NULL;
+    }
+    g -> buf = *v;
+    g -> gap_begin = v -> length;
+    g -> gap_end = v -> capacity;
+    free(v);
+    *err = no_err;
+    return g;
+}
+
+Vector gvec_into_vec(
+        GapVector g,
+        vec_err* __restrict const err
+        ){
+    if ( g == NULL || g -> buf.array == NULL ){
+        *err = null_vec_err;
+        return NULL;
+    }
+    Vector v = (Vector)malloc(VECSIZE);
+    if ( v == NULL ){
+        *err = alloc_err;
+        return NULL;
+    }
+    const u64 length = in_gvec_len(g);
+    in_gvec_move_gap(g, length);
+    *v = g -> buf;
+    v -> length = length;
+    free(g);
+    *err = no_err;
+    return v;
+}
+
+void gvec_destroy(GapVector g, vec_err* __restrict const err){
+    if ( g == NULL ){
+        *err = null_vec_err;
+        return;
+    }
+    if ( g -> buf.array == NULL ){
+        free(g);
+        *err = null_vec_err;
+        return;
+    }
+    in_arr_free(&g -> buf);
+    free(g);
+    *err = no_err;
+}
+
+u64 gvec_len(__restrict const cGapVector g, vec_err* __restrict const err){
+    if ( g == NULL ){
+        *err = null_vec_err;
+        return 0;
+    }
+    *err = no_err;
+    return in_gvec_len(g);
+}
+
+void gvec_insert_(
+        GapVector g,
+        const void* const element,
+        const u64 index,
+        vec_err* __restrict const err
+        ){
+    if ( g == NULL || g -> buf.array == NULL ){
+        *err = null_vec_err;
+        return;
+    }
+    if ( index > in_gvec_len(g) ){
+        *err = index_out_of_bounds_err;
+        return;
+    }
+    if ( g -> gap_begin == g -> gap_end ){
+        in_gvec_grow(g, err);
+        if ( *err != no_err ) return;
+    }
+    in_gvec_move_gap(g, index);
+    memcpy(
+        g -> buf.array + g -> gap_begin * g -> buf.element_size,
+        element,
+        g -> buf.element_size
+    );
+    g -> gap_begin ++;
+    VEC_STAT(&g -> buf, bytes_copied, g -> buf.element_size);
+    *err = no_err;
+}
+
+void gvec_push_(
+        GapVector g,
+        const void* const element,
+        vec_err* __restrict const err
+        ){
+    if ( g == NULL || g -> buf.array == NULL ){
+        *err = null_vec_err;
+        return;
+    }
+    gvec_insert_(g, element, in_gvec_len(g), err);
+}
+
+void* gvec_remove_(
+        GapVector g,
+        const u64 index,
+        vec_err* __restrict const err
+        ){
+    if ( g == NULL || g -> buf.array == NULL ){
+        *err = null_vec_err;
+        return NULL;
+    }
+    if ( in_gvec_len(g) == 0 ){
+        *err = illegal_del_err;
+        return NULL;
+    }
+    if ( index >= in_gvec_len(g) ){
+        *err = index_out_of_bounds_err;
+        return NULL;
+    }
+    void* out = malloc(g -> buf.element_size);
+    if ( out == NULL ){
+        *err = alloc_err;
+        return NULL;
+    }
+    in_gvec_move_gap(g, index);
+    memcpy(
+        out,
+        g -> buf.array + g -> gap_end * g -> buf.element_size,
+        g -> buf.element_size
+    );
+    g -> gap_end ++;
+    VEC_STAT(&g -> buf, allocs, 1);
+    VEC_STAT(&g -> buf, bytes_copied, g -> buf.element_size);
+    *err = no_err;
+    return out;
+}
+
+void* gvec_get_(
+        __restrict const cGapVector g,
+        const u64 index,
+        vec_err* __restrict const err
+        ){
+    if ( g == NULL || g -> buf.array == NULL ){
+        *err = null_vec_err;
+        return NULL;
+    }
+    if ( in_gvec_len(g) == 0 ){
+        *err = illegal_acces_err;
+        return NULL;
+    }
+    if ( index >= in_gvec_len(g) ){
+        *err = index_out_of_bounds_err;
+        return NULL;
+    }
+    void* out = malloc(g -> buf.element_size);
+    if ( out == NULL ){
+        *err = alloc_err;
+        return NULL;
+    }
+    memcpy(out, in_gvec_at(g, index), g -> buf.element_size);
+    VEC_STAT(&g -> buf, allocs, 1);
+    VEC_STAT(&g -> buf, bytes_copied, g -> buf.element_size);
+    *err = no_err;
+    return out;
+}
+
+void gvec_foreach_(
+        __restrict const cGapVector g,
+        void (* const function)(const void* const)
+        ){
+    if ( g == NULL || g -> buf.array == NULL ) return;
+    const u64 es = g -> buf.element_size;
+    for ( u64 i = 0; i < g -> gap_begin; i++ )
+        function(g -> buf.array + i * es);
+    for ( u64 i = g -> gap_end; i < g -> buf.capacity; i++ )
+        function(g -> buf.array + i * es);
+}
+
+
+
+/*
+ *  merge sort
+ *  a bottom up merge sort, runs of MERGE_RUN elements are first put in order by insertion and then merged
+ *  back and forth between the array and a scratch buffer of the same size, equal elements keep their order
+ *  the comparison goes through in_order_cmp so that the same code sorts elements and indexes of elements
+ */
+
+enum{
+    MERGE_RUN = 16,
+};
+
+typedef struct{
+    const CmpState(* cmp)(const void* const, const void* const);
+    const void* data;           // set when sorting indexes into data
+    u64         element_size;
+    vec_stats*  tally;
+} in_order;
+
+static inline CmpState in_order_cmp(const in_order* const o, const void* const a, const void* const b){
+    VEC_TALLY(o -> tally, comparisons, 1);
+    if ( o -> data == NULL )
+        return o -> cmp(a, b);
+    return o -> cmp(
+        o -> data + *(const u64*)a * o -> element_size,
+        o -> data + *(const u64*)b * o -> element_size
+    );
+}
+
+static void in_merge_sort(
+        void* const a,
+        const u64 n,
+        const u64 es,
+        void* const scratch,
+        const in_order* const o
+        ){
+    for ( u64 b = 0; b < n; b += MERGE_RUN ){
+        const u64 e = b + MERGE_RUN < n ? b + MERGE_RUN : n;
+        for ( u64 i = b + 1; i < e; i++ ){
+            memcpy(scratch, a + i * es, es);
+            u64 j = i;
+            while ( j > b && in_order_cmp(o, a + ( j - 1 ) * es, scratch) == sup ){
+                memcpy(a + j * es, a + ( j - 1 ) * es, es);
+                j --;
+            }
+            if ( j != i ) memcpy(a + j * es, scratch, es);
+        }
+    }
+    void* from = a;
+    void* to = scratch;
+    for ( u64 width = MERGE_RUN; width < n; width *= 2 ){
+        for ( u64 b = 0; b < n; b += 2 * width ){
+            const u64 m = b + width < n ? b + width : n;
+            const u64 e = b + 2 * width < n ? b + 2 * width : n;
+            u64 i = b, j = m, w = b;
+            while ( i < m && j < e ){
+                if ( in_order_cmp(o, from + j * es, from + i * es) == inf )
+                    memcpy(to + ( w++ ) * es, from + ( j++ ) * es, es);
+                else
+                    memcpy(to + ( w++ ) * es, from + ( i++ ) * es, es);
+            }
+            memcpy(to + w * es, from + i * es, ( m - i ) * es);
+            w += m - i;
+            memcpy(to + w * es, from + j * es, ( e - j ) * es);
+        }
+        void* const swap = from;
+        from = to;
+        to = swap;
+        VEC_TALLY(o -> tally, bytes_copied, n * es);
+    }
+    if ( from != a ){
+        memcpy(a, from, n * es);
+        VEC_TALLY(o -> tally, bytes_copied, n * es);
+    }
+}
+
+static inline void in_fset_invalidate(FlatSet s){
+    free(s -> eytz);
+    free(s -> eytz_index);
+    s -> eytz = NULL;
+    s -> eytz_index = NULL;
+}
+
+static u64 in_fset_eytz_fill(FlatSet s, u64 i, const u64 k){
+    const Vector v = s -> items;
+    if ( k > v -> length ) return i;
+    i = in_fset_eytz_fill(s, i, 2 * k);
+    memcpy(s -> eytz + k * v -> element_size, v -> array + i * v -> element_size, v -> element_size);
+    s -> eytz_index[k] = i;
+    return in_fset_eytz_fill(s, i + 1, 2 * k + 1);
+}
+
+// brings the eytzinger copy up to date after a modification, searches fall back on items when it fails
+static void in_fset_sync(FlatSet s){
+    if ( s -> layout != fset_eytzinger ) return;
+    const Vector v = s -> items;
+    void* const eytz = realloc(s -> eytz, ( v -> length + 1 ) * v -> element_size);
+    if ( eytz == NULL ){
+        in_fset_invalidate(s);
+        return;
+    }
+    s -> eytz = eytz;
+    u64* const index = (u64*)realloc(s -> eytz_index, ( v -> length + 1 ) * sizeof(u64));
+    if ( index == NULL ){
+        in_fset_invalidate(s);
+        return;
+    }
+    s -> eytz_index = index;
+    in_fset_eytz_fill(s, 0, 1);
+    VEC_STAT(v, reallocs, 2);
+    VEC_STAT(v, bytes_copied, v -> length * v -> element_size);
+}
+
+// index of the first element not less than key
+static u64 in_fset_lower_bound(cFlatSet s, const void* const key){
+    const Vector v = s -> items;
+    const u64 es = v -> element_size;
+    if ( s -> eytz != NULL ){
+        u64 k = 1;
+        while ( k <= v -> length )
+            k = 2 * k + ( s -> cmp(s -> eytz + k * es, key) < 0 );
+        k >>= __builtin_ffsll(~k);
+        return k == 0 ? v -> length : s -> eytz_index[k];
+    }
+    u64 base = 0, n = v -> length;
+    while ( n > 1 ){
+        const u64 half = n / 2;
+        base = s -> cmp(v -> array + ( base + half ) * es, key) < 0 ? base + half : base;
+        n -= half;
+    }
+    if ( n == 1 && s -> cmp(v -> array + base * es, key) < 0 ) base ++;
+    return base;
+}
+
+static inline int in_fset_equal_at(cFlatSet s, const u64 index, const void* const key){
+    return index < s -> items -> length
+        && s -> cmp(s -> items -> array + index * s -> items -> element_size, key) == eq;
+}
+
+FlatSet fset_init_(
+        u64 element_size,
+        u64 def_capa,
+        const CmpState(* const cmp)(const void* const, const void* const),
+        const fset_layout layout,
+        vec_err* __restrict const err
+        ){
+    FlatSet s = (FlatSet)malloc(FSETSIZE);
+    if ( s == NULL ){
+        *err = alloc_err;
+        return NULL;
+    }
+    s -> items = in_vec_init(element_size, def_capa, err);
+    if ( *err != no_err ){
+        free(s);
+        return NULL;
+    }
+    s -> cmp = cmp;
+    s -> layout = layout;
+    s -> eytz = NULL;
+    s -> eytz_index = NULL;
+    return s;
+}
+
+void fset_destroy(FlatSet s, vec_err* __restrict const err){
+    if ( s == NULL ){
+        *err = null_vec_err;
+        return;
+    }
+    in_fset_invalidate(s);
+    in_vec_destroy(s -> items, err);
+    free(s);
+}
+
+u64 fset_len(__restrict const cFlatSet s, vec_err* __restrict const err){
+    if ( s == NULL ){
+        *err = null_vec_err;
+        return 0;
+    }
+    return vec_len(s -> items, err);
+}
+
+const void* fset_at_(
+        __restrict const cFlatSet s,
+        const u64 index,
+        vec_err* __restrict const err
+        ){
+    if ( s == NULL || s -> items -> array == NULL ){
+        *err = null_vec_err;
+        return NULL;
+    }
+    if ( index >= s -> items -> length ){
+        *err = index_out_of_bounds_err;
+        return NULL;
+    }
+    *err = no_err;
+    return s -> items -> array + index * s -> items -> element_size;
+}
+
+u64 fset_lower_bound_(
+        __restrict const cFlatSet s,
+        const void* const key,
+        vec_err* __restrict const err
+        ){
+    if ( s == NULL || s -> items -> array == NULL ){
+        *err = null_vec_err;
+        return 0;
+    }
+    *err = no_err;
+    return in_fset_lower_bound(s, key);
+}
+
+u64 fset_find_(
+        __restrict const cFlatSet s,
+        const void* const key,
+        vec_err* __restrict const err
+        ){
+    if ( s == NULL || s -> items -> array == NULL ){
+        *err = null_vec_err;
+        return 0;
+    }
+    const u64 index = in_fset_lower_bound(s, key);
+    *err = no_err;
+    return in_fset_equal_at(s, index, key) ? index : s -> items -> length;
+}
+
+static int in_fset_insert(
+        FlatSet s,
+        const void* const element,
+        const int overwrite,
+        vec_err* __restrict const err
+        ){
+    if ( s == NULL || s -> items -> array == NULL ){
+        *err = null_vec_err;
+        return 0;
+    }
+    const Vector v = s -> items;
+    const u64 index = in_fset_lower_bound(s, element);
+    if ( in_fset_equal_at(s, index, element) ){
+        if ( overwrite ){
+            if ( in_vec_own(v, err) != 0 ) return 0;
+            memcpy(v -> array + index * v -> element_size, element, v -> element_size);
+            in_fset_sync(s);
+        }
+        *err = no_err;
+        return 0;
+    }
+    vec_insert_(v, element, index, err);
+    if ( *err != no_err ) return 0;
+    in_fset_sync(s);
+    return 1;
+}
+
+int fset_insert_(
+        FlatSet s,
+        const void* const element,
+        vec_err* __restrict const err
+        ){
+    return in_fset_insert(s, element, 0, err);
+}
+
+int fset_upsert_(
+        FlatSet s,
+        const void* const element,
+        vec_err* __restrict const err
+        ){
+    return in_fset_insert(s, element, 1, err);
+}
+
+u64 fset_insert_many_(
+        FlatSet s,
+        __restrict const cVector batch,
+        vec_err* __restrict const err
+        ){
+    if ( s == NULL || s -> items -> array == NULL || batch == NULL || batch -> array == NULL ){
+        *err = null_vec_err;
+        return 0;
+    }
+    const Vector v = s -> items;
+    const u64 es = v -> element_size;
+    if ( batch -> element_size != es ){
+        *err = illegal_acces_err;
+        return 0;
+    }
+    if ( batch -> length == 0 ){
+        *err = no_err;
+        return 0;
+    }
+    if ( in_vec_own(v, err) != 0 )
+        return 0;
+
+    // merge sort a private copy of the batch, with the scratch half after it, and drop its own duplicates
+    void* sorted = malloc(2 * batch -> length * es);
+    if ( sorted == NULL ){
+        *err = alloc_err;
+        return 0;
+    }
+    memcpy(sorted, batch -> array, batch -> length * es);
+    vec_stats tally = { 0 };
+    const in_order o = { s -> cmp, NULL, es, &tally };
+    in_merge_sort(sorted, batch -> length, es, sorted + batch -> length * es, &o);
+    VEC_STAT(v, sorts, 1);
+    VEC_STAT(v, comparisons, tally.comparisons);
+    VEC_STAT(v, allocs, 1);
+    VEC_STAT(v, bytes_copied, tally.bytes_copied + batch -> length * es);
+    u64 m = 1;
+    for ( u64 i = 1; i < batch -> length; i++ ){
+        if ( s -> cmp(sorted + ( m - 1 ) * es, sorted + i * es) == eq ) continue;
+        if ( m != i ) memcpy(sorted + m * es, sorted + i * es, es);
+        m ++;
+    }
+
+    if ( v -> length + m > v -> capacity ){
+        const u64 doubled = v -> capacity * 2;
+        if ( in_arr_resize(v, doubled > v -> length + m ? doubled : v -> length + m) != 0 ){
+            free(sorted);
+            *err = realloc_err;
+            return 0;
+        }
+    }
+
+    // merge from the back so that no element of the set is overwritten before it is read
+    u64 i = v -> length, j = m, w = v -> length + m;
+    while ( j > 0 ){
+        if ( i == 0 ){
+            w --; j --;
+            memcpy(v -> array + w * es, sorted + j * es, es);
+            continue;
+        }
+        const CmpState c = s -> cmp(v -> array + ( i - 1 ) * es, sorted + ( j - 1 ) * es);
+        if ( c == eq ){
+            j --;
+            continue;
+        }
+        w --;
+        if ( c == sup ){
+            i --;
+            memcpy(v -> array + w * es, v -> array + i * es, es);
+        }
+        else{
+            j --;
+            memcpy(v -> array + w * es, sorted + j * es, es);
+        }
+    }
+    // i elements of the set are still in place, duplicates left a hole of w - i before the merged tail
+    const u64 added = m - ( w - i );
+    if ( w != i )
+        memmove(v -> array + i * es, v -> array + w * es, ( v -> length + m - w ) * es);
+    VEC_STAT(v, bytes_moved, ( v -> length + m - i ) * es);
+    v -> length += added;
+    free(sorted);
+    in_fset_sync(s);
+    *err = no_err;
+    return added;
+}
+
+int fset_erase_(
+        FlatSet s,
+        const void* const key,
+        vec_err* __restrict const err
+        ){
+    if ( s == NULL || s -> items -> array == NULL ){
+        *err = null_vec_err;
+        return 0;
+    }
+    const Vector v = s -> items;
+    const u64 index = in_fset_lower_bound(s, key);
+    *err = no_err;
+    if ( !in_fset_equal_at(s, index, key) ) return 0;
+    if ( in_vec_own(v, err) != 0 ) return 0;
+    memmove(
+        v -> array + index * v -> element_size,
+        v -> array + ( index + 1 ) * v -> element_size,
+        ( v -> length - index - 1 ) * v -> element_size
+    );
+    VEC_STAT(v, bytes_moved, ( v -> length - index - 1 ) * v -> element_size);
+    v -> length --;
+    in_fset_sync(s);
+    return 1;
+}
+
+Vector fset_range_(
+        __restrict const cFlatSet s,
+        const void* const lo,
+        const void* const hi,
+        vec_err* __restrict const err
+        ){
+    if ( s == NULL || s -> items -> array == NULL ){
+        *err = null_vec_err;
+        return NULL;
+    }
+    const Vector v = s -> items;
+    const u64 b = in_fset_lower_bound(s, lo);
+    const u64 e = in_fset_lower_bound(s, hi);
+    const u64 n = e > b ? e - b : 0;
+    Vector out = in_vec_init(v -> element_size, n, err);
+    if ( *err != no_err ) return NULL;
+    memcpy(out -> array, v -> array + b * v -> element_size, n * v -> element_size);
+    out -> length = n;
+    VEC_STAT(v, bytes_copied, n * v -> element_size);
+    return out;
+}
+
+cVector fset_items(__restrict const cFlatSet s, vec_err* __restrict const err){
+    if ( s == NULL ){
+        *err = null_vec_err;
+        return NULL;
+    }
+    *err = no_err;
+    return s -> items;
+}
+
+
+
+void vec_truncate(cVector v, const u64 length, vec_err* __restrict const err){
+    if ( v == NULL || v -> array == NULL ){
+        *err = null_vec_err;
+        return;
+    }
+    if ( length > v -> length ){
+        *err = index_out_of_bounds_err;
+        return;
+    }
+    v -> length = length;
+    *err = no_err;
+}
+
+
+/*
+ *  heaps
+ *  a d-ary max heap laid out in the array, the children of i are d*i+1 .. d*i+d
+ *  the sifts move a hole instead of swapping and write x into it once at the end,
+ *  x must not point into the part of the array the hole goes through, reversed turns
+ *  it into a min heap without wrapping cmp
+ */
+
+static inline CmpState in_heap_cmp(
+        const CmpState(* const cmp)(const void* const, const void* const),
+        const int reversed,
+        const void* const a,
+        const void* const b
+        ){
+    return reversed ? cmp(b, a) : cmp(a, b);
+}
+
+static void in_heap_sift_up(
+        void* const a,
+        u64 hole,
+        const void* const x,
+        const u64 es,
+        const CmpState(* const cmp)(const void* const, const void* const),
+        const int reversed,
+        const u64 d,
+        vec_stats* const tally
+        ){
+    while ( hole > 0 ){
+        const u64 parent = ( hole - 1 ) / d;
+        VEC_TALLY(tally, comparisons, 1);
+        if ( in_heap_cmp(cmp, reversed, a + parent * es, x) != inf ) break;
+        memcpy(a + hole * es, a + parent * es, es);
+        hole = parent;
+    }
+    memcpy(a + hole * es, x, es);
+}
+
+static void in_heap_sift_down(
+        void* const a,
+        const u64 n,
+        u64 hole,
+        const void* const x,
+        const u64 es,
+        const CmpState(* const cmp)(const void* const, const void* const),
+        const int reversed,
+        const u64 d,
+        vec_stats* const tally
+        ){
+    for ( ;; ){
+        const u64 first = hole * d + 1;
+        if ( first >= n ) break;
+        const u64 last = first + d < n ? first + d : n;
+        u64 best = first;
+        for ( u64 c = first + 1; c < last; c++ ){
+            VEC_TALLY(tally, comparisons, 1);
+            if ( in_heap_cmp(cmp, reversed, a + c * es, a + best * es) == sup ) best = c;
+        }
+        VEC_TALLY(tally, comparisons, 1);
+        if ( in_heap_cmp(cmp, reversed, a + best * es, x) != sup ) break;
+        memcpy(a + hole * es, a + best * es, es);
+        hole = best;
+    }
+    memcpy(a + hole * es, x, es);
+}
+
+static inline void in_heap_tally(cVector v, const vec_stats* const tally){
+    VEC_STAT(v, comparisons, tally -> comparisons);
+    (void)v; (void)tally;
+}
+
+void vec_make_heap(
+        Vector v,
+        const CmpState(* const cmp)(const void* const, const void* const),
+        u64 arity,
+        vec_err* __restrict const err
+        ){
+    if ( v == NULL || v -> array == NULL ){
+        *err = null_vec_err;
+        return;
+    }
+    arity = arity < 2 ? 2 : arity;
+    if ( in_vec_own(v, err) != 0 ) return;
+    *err = no_err;
+    if ( v -> length < 2 ) return;
+    void* x = malloc(v -> element_size);
+    if ( x == NULL ){
+        *err = alloc_err;
+        return;
+    }
+    vec_stats tally = { 0 };
+    for ( u64 i = ( v -> length - 2 ) / arity + 1; i-- > 0; ){
+        memcpy(x, v -> array + i * v -> element_size, v -> element_size);
+        in_heap_sift_down(v -> array, v -> length, i, x, v -> element_size, cmp, 0, arity, &tally);
+    }
+    free(x);
+    VEC_STAT(v, allocs, 1);
+    in_heap_tally(v, &tally);
+}
+
+void vec_heap_push(
+        Vector v,
+        const void* const element,
+        const CmpState(* const cmp)(const void* const, const void* const),
+        u64 arity,
+        vec_err* __restrict const err
+        ){
+    if ( v == NULL || v -> array == NULL ){
+        *err = null_vec_err;
+        return;
+    }
+    arity = arity < 2 ? 2 : arity;
+    if ( in_vec_own(v, err) != 0 ) return;
+    if ( v -> length == v -> capacity ){
+        in_vec_grow(v, err);
+        if ( *err != no_err ) return;
+    }
+    vec_stats tally = { 0 };
+    in_heap_sift_up(v -> array, v -> length, element, v -> element_size, cmp, 0, arity, &tally);
+    v -> length ++;
+    in_heap_tally(v, &tally);
+    *err = no_err;
+}
+
+void vec_heap_pop_into(
+        Vector v,
+        void* const out,
+        const CmpState(* const cmp)(const void* const, const void* const),
+        u64 arity,
+        vec_err* __restrict const err
+        ){
+    if ( v == NULL || v -> array == NULL ){
+        *err = null_vec_err;
+        return;
+    }
+    if ( v -> length == 0 ){
+        *err = illegal_del_err;
+        return;
+    }
+    arity = arity < 2 ? 2 : arity;
+    if ( in_vec_own(v, err) != 0 ) return;
+    memcpy(out, v -> array, v -> element_size);
+    v -> length --;
+    vec_stats tally = { 0 };
+    if ( v -> length > 0 )
+        in_heap_sift_down(
+            v -> array, v -> length, 0,
+            v -> array + v -> length * v -> element_size,
+            v -> element_size, cmp, 0, arity, &tally
+        );
+    in_heap_tally(v, &tally);
+    *err = no_err;
+}
+
+void vec_heap_replace_top(
+        Vector v,
+        const void* const element,
+        void* const out,
+        const CmpState(* const cmp)(const void* const, const void* const),
+        u64 arity,
+        vec_err* __restrict const err
+        ){
+    if ( v == NULL || v -> array == NULL ){
+        *err = null_vec_err;
+        return;
+    }
+    if ( v -> length == 0 ){
+        *err = illegal_acces_err;
+        return;
+    }
+    arity = arity < 2 ? 2 : arity;
+    if ( in_vec_own(v, err) != 0 ) return;
+    if ( out != NULL )
+        memcpy(out, v -> array, v -> element_size);
+    vec_stats tally = { 0 };
+    in_heap_sift_down(v -> array, v -> length, 0, element, v -> element_size, cmp, 0, arity, &tally);
+    in_heap_tally(v, &tally);
+    *err = no_err;
+}
+
+
+
+static Pipeline in_pipe_init(
+        const void* const data,
+        const Vector source,
+        const u64 begin,
+        const u64 end,
+        const u64 element_size,
+        vec_err* __restrict const err
+        ){
+    Pipeline p = (Pipeline)malloc(PIPESIZE);
+    if ( p == NULL ){
+        *err = alloc_err;
+        return NULL;
+    }
+    p -> stages = in_vec_init(sizeof(struct pipe_stage), 4, err);
+    if ( *err != no_err ){
+        free(p);
+        return NULL;
+    }
+    p -> data = data;
+    p -> source = source;
+    p -> begin = begin;
+    p -> end = end;
+    p -> element_size = element_size;
+    return p;
+}
+
+Pipeline pipe_from_(__restrict const cVector v, vec_err* __restrict const err){
+    if ( v == NULL || v -> array == NULL ){
+        *err = null_vec_err;
+        return NULL;
+    }
+    return in_pipe_init(NULL, v, 0, v -> length, v -> element_size, err);
+}
+
+Pipeline pipe_from_range_(
+        __restrict const cVector v,
+        const u64 b,
+        const u64 e,
+        vec_err* __restrict const err
+        ){
+    if ( v == NULL || v -> array == NULL ){
+        *err = null_vec_err;
+        return NULL;
+    }
+    if ( b > e || e > v -> length ){
+        *err = illegal_acces_err;
+        return NULL;
+    }
+    return in_pipe_init(NULL, v, b, e, v -> element_size, err);
+}
+
+Pipeline pipe_from_view_(
+        const void* const data,
+        const u64 length,
+        const u64 element_size,
+        vec_err* __restrict const err
+        ){
+    if ( data == NULL ){
+        *err = null_vec_err;
+        return NULL;
+    }
+    return in_pipe_init(data, NULL, 0, length, element_size, err);
+}
+
+void pipe_destroy(Pipeline p, vec_err* __restrict const err){
+    if ( p == NULL ){
+        *err = null_vec_err;
+        return;
+    }
+    in_vec_destroy(p -> stages, err);
+    free(p);
+}
+
+// end of the input when running, a source shortened since the pipeline was built is read up to its length
+static inline u64 in_pipe_end(cPipeline p){
+    if ( p -> source == NULL || p -> end <= p -> source -> length ) return p -> end;
+    return p -> source -> length > p -> begin ? p -> source -> length : p -> begin;
+}
+
+static inline u64 in_pipe_element_size(cPipeline p){
+    const struct pipe_stage* const stages = (struct pipe_stage*)p -> stages -> array;
+    return p -> stages -> length != 0
+        ? stages[p -> stages -> length - 1].element_size
+        : p -> element_size;
+}
+
+static void in_pipe_add(cPipeline p, struct pipe_stage stage, vec_err* __restrict const err){
+    if ( p == NULL ){
+        *err = null_vec_err;
+        return;
+    }
+    if ( stage.element_size == 0 )
+        stage.element_size = in_pipe_element_size(p);
+    in_vec_push(p -> stages, &stage, err);
+}
+
+void pipe_map_(
+        Pipeline p,
+        const u64 out_element_size,
+        void (* const function)(const void* const, void* const),
+        vec_err* __restrict const err
+        ){
+    in_pipe_add(p, (struct pipe_stage){ .kind = pipe_map, .element_size = out_element_size, .map = function }, err);
+}
+
+void pipe_filter_(
+        Pipeline p,
+        int (* const predicate)(const void* const),
+        vec_err* __restrict const err
+        ){
+    in_pipe_add(p, (struct pipe_stage){ .kind = pipe_filter, .filter = predicate }, err);
+}
+
+void pipe_take_(Pipeline p, const u64 n, vec_err* __restrict const err){
+    in_pipe_add(p, (struct pipe_stage){ .kind = pipe_take, .n = n }, err);
+}
+
+void pipe_zip_(
+        Pipeline p,
+        __restrict const cVector other,
+        const u64 out_element_size,
+        void (* const function)(const void* const, const void* const, void* const),
+        vec_err* __restrict const err
+        ){
+    if ( other == NULL || other -> array == NULL ){
+        *err = null_vec_err;
+        return;
+    }
+    in_pipe_add(p, (struct pipe_stage){
+        .kind = pipe_zip, .element_size = out_element_size, .zip = function, .other = other
+    }, err);
+}
+
+// where each element surviving the pipeline goes, returns non zero to stop on failure
+typedef int (* pipe_sink)(void* const ctx, const void* const element);
+
+/*
+ *  runs every stage over [begin, end) of the input, one element at a time, between two scratch slots
+ *  position is the index of begin relative to the start of the input, used by the zips
+ */
+static void in_pipe_drive(
+        cPipeline p,
+        const u64 begin,
+        const u64 end,
+        const u64 position,
+        const pipe_sink sink,
+        void* const ctx,
+        vec_err* __restrict const err
+        ){
+    const struct pipe_stage* const stages = (struct pipe_stage*)p -> stages -> array;
+    const u64 count = p -> stages -> length;
+    u64 slot = in_round_up(p -> element_size, 16);
+    for ( u64 k = 0; k < count; k++ )
+        if ( in_round_up(stages[k].element_size, 16) > slot ) slot = in_round_up(stages[k].element_size, 16);
+    void* const scratch = malloc(2 * slot + ( count + 1 ) * sizeof(u64));
+    if ( scratch == NULL ){
+        *err = alloc_err;
+        return;
+    }
+    u64* const counters = (u64*)( scratch + 2 * slot );
+    for ( u64 k = 0; k < count; k++ )
+        counters[k] = stages[k].kind == pipe_zip ? position : 0;
+
+    const void* const data = p -> source != NULL ? p -> source -> array : p -> data;
+    *err = no_err;
+    for ( u64 i = begin; i < end; i++ ){
+        const void* current = data + i * p -> element_size;
+        u64 which = 0;
+        for ( u64 k = 0; k < count; k++ ){
+            const struct pipe_stage* const st = stages + k;
+            void* const next = scratch + which * slot;
+            switch ( st -> kind ){
+                case pipe_map:
+                    st -> map(current, next);
+                    current = next;
+                    which ^= 1;
+                    break;
+                case pipe_filter:
+                    if ( !st -> filter(current) ) goto next_element;
+                    break;
+                case pipe_take:
+                    if ( counters[k] >= st -> n ) goto done;
+                    counters[k] ++;
+                    break;
+                case pipe_zip:
+                    if ( counters[k] >= st -> other -> length ) goto done;
+                    st -> zip(
+                        current,
+                        st -> other -> array + counters[k] * st -> other -> element_size,
+                        next
+                    );
+                    counters[k] ++;
+                    current = next;
+                    which ^= 1;
+                    break;
+            }
+        }
+        if ( sink(ctx, current) != 0 ){
+            *err = realloc_err;
+            goto done;
+        }
+next_element:
+        ;
+    }
+done:
+    free(scratch);
+}
+
+static int in_pipe_push_sink(void* const ctx, const void* const element){
+    vec_err err;
+    in_vec_push((Vector)ctx, element, &err);
+    return err != no_err;
+}
+
+typedef struct{
+    void* dest;
+    u64   element_size;
+} pipe_store;
+
+static int in_pipe_store_sink(void* const ctx, const void* const element){
+    pipe_store* const store = (pipe_store*)ctx;
+    memcpy(store -> dest, element, store -> element_size);
+    store -> dest += store -> element_size;
+    return 0;
+}
+
+typedef struct{
+    void* acc;
+    void  (* function)(void* const, const void* const);
+} pipe_folder;
+
+static int in_pipe_fold_sink(void* const ctx, const void* const element){
+    pipe_folder* const folder = (pipe_folder*)ctx;
+    folder -> function(folder -> acc, element);
+    return 0;
+}
+
+Vector pipe_collect_(__restrict const cPipeline p, vec_err* __restrict const err){
+    if ( p == NULL ){
+        *err = null_vec_err;
+        return NULL;
+    }
+    const u64 end = in_pipe_end(p);
+    Vector out = in_vec_init(in_pipe_element_size(p), end - p -> begin, err);
+    if ( *err != no_err ) return NULL;
+    in_pipe_drive(p, p -> begin, end, 0, in_pipe_push_sink, out, err);
+    if ( *err != no_err ){
+        vec_err ignored;
+        in_vec_destroy(out, &ignored);
+        return NULL;
+    }
+    return out;
+}
+
+void pipe_fold_(
+        __restrict const cPipeline p,
+        void* const acc,
+        void (* const function)(void* const, const void* const),
+        vec_err* __restrict const err
+        ){
+    if ( p == NULL ){
+        *err = null_vec_err;
+        return;
+    }
+    pipe_folder folder = { acc, function };
+    in_pipe_drive(p, p -> begin, in_pipe_end(p), 0, in_pipe_fold_sink, &folder, err);
+}
+
+typedef struct{
+    Pipeline  p;
+    u64       begin;
+    u64       end;
+    pipe_sink sink;
+    void*     ctx;
+    pipe_store store;
+    Vector    part;
+    vec_err   err;
+} pipe_chunk;
+
+static void* in_pipe_worker(void* const arg){
+    pipe_chunk* const chunk = (pipe_chunk*)arg;
+    in_pipe_drive(
+        chunk -> p, chunk -> begin, chunk -> end, chunk -> begin - chunk -> p -> begin,
+        chunk -> sink, chunk -> ctx, &chunk -> err
+    );
+    return NULL;
+}
+
+/*
+ *  splits the input in one chunk per thread, without filter every chunk knows where its output goes and
+ *  stores straight into the result, with filters every chunk fills its own part which are then appended
+ *  takes, and zips following a filter, depend on the order of the elements and run on a single thread
+ */
+Vector pipe_collect_par_(
+        __restrict const cPipeline p,
+        u64 threads,
+        vec_err* __restrict const err
+        ){
+    if ( p == NULL ){
+        *err = null_vec_err;
+        return NULL;
+    }
+    const struct pipe_stage* const stages = (struct pipe_stage*)p -> stages -> array;
+    int filtered = 0;
+    u64 length = in_pipe_end(p) - p -> begin;
+    for ( u64 k = 0; k < p -> stages -> length; k++ ){
+        if ( stages[k].kind == pipe_take || ( stages[k].kind == pipe_zip && filtered ) )
+            return pipe_collect_(p, err);
+        if ( stages[k].kind == pipe_filter ) filtered = 1;
+        if ( stages[k].kind == pipe_zip && stages[k].other -> length < length )
+            length = stages[k].other -> length;
+    }
+    if ( threads > length ) threads = length;
+    if ( threads < 2 )
+        return pipe_collect_(p, err);
+
+    const u64 es = in_pipe_element_size(p);
+    Vector out = in_vec_init(es, length, err);
+    if ( *err != no_err ) return NULL;
+    pipe_chunk* const chunks = (pipe_chunk*)calloc(threads, sizeof(pipe_chunk));
+    pthread_t* const ids = (pthread_t*)malloc(threads * sizeof(pthread_t));
+    if ( chunks == NULL || ids == NULL ){
+        *err = alloc_err;
+        goto failure;
+    }
+    u64 started = 0;
+    for ( u64 t = 0; t < threads; t++ ){
+        pipe_chunk* const chunk = chunks + t;
+        chunk -> p = p;
+        chunk -> begin = p -> begin + length * t / threads;
+        chunk -> end = p -> begin + length * ( t + 1 ) / threads;
+        if ( filtered ){
+            chunk -> part = in_vec_init(es, chunk -> end - chunk -> begin, &chunk -> err);
+            if ( chunk -> err != no_err ) break;
+            chunk -> sink = in_pipe_push_sink;
+            chunk -> ctx = chunk -> part;
+        }
+        else{
+            chunk -> store = (pipe_store){ out -> array + ( chunk -> begin - p -> begin ) * es, es };
+            chunk -> sink = in_pipe_store_sink;
+            chunk -> ctx = &chunk -> store;
+        }
+        if ( pthread_create(ids + t, NULL, in_pipe_worker, chunk) != 0 ){
+            chunk -> err = alloc_err;
+            break;
+        }
+        started ++;
+    }
+    *err = no_err;
+    for ( u64 t = 0; t < started; t++ )
+        pthread_join(ids[t], NULL);
+    for ( u64 t = 0; t < threads; t++ )
+        if ( chunks[t].err != no_err && *err == no_err ) *err = chunks[t].err;
+    if ( *err == no_err ){
+        if ( filtered ){
+            for ( u64 t = 0; t < threads; t++ ){
+                memcpy(
+                    out -> array + out -> length * es,
+                    chunks[t].part -> array,
+                    chunks[t].part -> length * es
+                );
+                out -> length += chunks[t].part -> length;
+            }
+            VEC_STAT(out, bytes_copied, out -> length * es);
+        }
+        else{
+            out -> length = length;
+            VEC_STAT(out, bytes_copied, length * es);
+        }
+    }
+failure:
+    if ( chunks != NULL ){
+        vec_err ignored;
+        for ( u64 t = 0; t < threads; t++ )
+            if ( chunks[t].part != NULL ) in_vec_destroy(chunks[t].part, &ignored);
+    }
+    free(chunks);
+    free(ids);
+    if ( *err != no_err ){
+        vec_err ignored;
+        in_vec_destroy(out, &ignored);
+        return NULL;
+    }
+    return out;
+}
+
+
+
+Vector vec_clone(__restrict const cVector v, vec_err* __restrict const err){
+    if ( v == NULL || v -> array == NULL ){
+        *err = null_vec_err;
+        return NULL;
+    }
+    Vector out = (Vector)malloc(VECSIZE);
+    if ( out == NULL ){
+        *err = alloc_err;
+        return NULL;
+    }
+    out -> length = v -> length;
+    VEC_STAT_INIT(out);
+    out -> capacity = v -> length != 0 ? v -> length : 10;
+    out -> element_size = v -> element_size;
+    out -> alignment = v -> alignment;
+    out -> refs = NULL;
+    out -> array = in_arr_alloc(out);
+    if ( out -> array == NULL ){
+        free(out);
+        *err = alloc_err;
+        return NULL;
+    }
+    memcpy(out -> array, v -> array, v -> length * v -> element_size);
+    VEC_STAT(out, allocs, 2);
+    VEC_STAT(out, bytes_copied, v -> length * v -> element_size);
+    VEC_STAT_PEAK(out);
+    *err = no_err;
+    return out;
+}
+
+Vector vec_share(__restrict const cVector v, vec_err* __restrict const err){
+    if ( v == NULL || v -> array == NULL ){
+        *err = null_vec_err;
+        return NULL;
+    }
+    Vector out = (Vector)malloc(VECSIZE);
+    if ( out == NULL ){
+        *err = alloc_err;
+        return NULL;
+    }
+    // several threads may share the same vector at once, only one of them installs the counter
+    u64* refs = __atomic_load_n(&v -> refs, __ATOMIC_ACQUIRE);
+    if ( refs == NULL ){
+        u64* const fresh = (u64*)malloc(sizeof(u64));
+        if ( fresh == NULL ){
+            free(out);
+            *err = alloc_err;
+            return NULL;
+        }
+        *fresh = 1;
+        if ( __atomic_compare_exchange_n(&v -> refs, &refs, fresh, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) )
+            refs = fresh;
+        else
+            free(fresh);
+    }
+    __atomic_add_fetch(refs, 1, __ATOMIC_RELAXED);
+    out -> array = v -> array;
+    out -> length = v -> length;
+    out -> capacity = v -> capacity;
+    out -> element_size = v -> element_size;
+    out -> alignment = v -> alignment;
+    out -> mapped = v -> mapped;
+    out -> refs = refs;
+    VEC_STAT_INIT(out);
+    VEC_STAT(out, allocs, 1);
+    *err = no_err;
+    return out;
+}
+
+void* vec_data_(__restrict const cVector v, vec_err* __restrict const err){
+    if ( v == NULL || v -> array == NULL ){
+        *err = null_vec_err;
+        return NULL;
+    }
+    if ( in_vec_own(v, err) != 0 )
+        return NULL;
+    *err = no_err;
+    return v -> array;
+}
+
+const void* vec_cdata_(__restrict const cVector v, vec_err* __restrict const err){
+    if ( v == NULL || v -> array == NULL ){
+        *err = null_vec_err;
+        return NULL;
+    }
+    *err = no_err;
+    return v -> array;
+}
+
+
+
+/*
+ *  stable sorts, all through in_merge_sort
+ */
+
+static inline void in_sort_tally(cVector v, const vec_stats* const tally){
+    VEC_STAT(v, sorts, 1);
+    VEC_STAT(v, comparisons, tally -> comparisons);
+    VEC_STAT(v, bytes_copied, tally -> bytes_copied);
+    (void)v; (void)tally;
+}
+
+Vector vec_stable_sort_(
+        __restrict const cVector v,
+        const CmpState(* const cmp)(const void* const, const void* const),
+        vec_err* __restrict const err
+        ){
+    if ( v == NULL || v -> array == NULL ){
+        *err = null_vec_err;
+        return NULL;
+    }
+    Vector out = in_vec_init(v -> element_size, v -> length, err);
+    if ( *err != no_err ) return NULL;
+    if ( v -> length == 0 ) return out;
+    void* const scratch = malloc(v -> length * v -> element_size);
+    if ( scratch == NULL ){
+        vec_err ignored;
+        in_vec_destroy(out, &ignored);
+        *err = alloc_err;
+        return NULL;
+    }
+    memcpy(out -> array, v -> array, v -> length * v -> element_size);
+    out -> length = v -> length;
+    vec_stats tally = { 0 };
+    const in_order o = { cmp, NULL, v -> element_size, &tally };
+    in_merge_sort(out -> array, out -> length, out -> element_size, scratch, &o);
+    free(scratch);
+    VEC_STAT(v, allocs, 1);
+    VEC_STAT(v, bytes_copied, v -> length * v -> element_size);
+    in_sort_tally(v, &tally);
+    *err = no_err;
+    return out;
+}
+
+Vector vec_argsort(
+        __restrict const cVector v,
+        const CmpState(* const cmp)(const void* const, const void* const),
+        vec_err* __restrict const err
+        ){
+    if ( v == NULL || v -> array == NULL ){
+        *err = null_vec_err;
+        return NULL;
+    }
+    Vector out = in_vec_init(sizeof(u64), v -> length, err);
+    if ( *err != no_err ) return NULL;
+    if ( v -> length == 0 ) return out;
+    u64* const scratch = (u64*)malloc(v -> length * sizeof(u64));
+    if ( scratch == NULL ){
+        vec_err ignored;
+        in_vec_destroy(out, &ignored);
+        *err = alloc_err;
+        return NULL;
+    }
+    u64* const index = (u64*)out -> array;
+    for ( u64 i = 0; i < v -> length; i++ )
+        index[i] = i;
+    out -> length = v -> length;
+    vec_stats tally = { 0 };
+    const in_order o = { cmp, v -> array, v -> element_size, &tally };
+    in_merge_sort(index, out -> length, sizeof(u64), scratch, &o);
+    free(scratch);
+    VEC_STAT(v, allocs, 1);
+    in_sort_tally(v, &tally);
+    *err = no_err;
+    return out;
+}
+
+/*
+ *  moves v[perm[i]] to v[i] in every vector of vs following the cycles of perm, so that every element is moved
+ *  once through a single temporary, one bit per element marks where perm was already applied. everything that
+ *  may fail ( checking the permutation, allocating, copying shared arrays ) is done before the first element
+ *  moves so that either all of the vectors are permuted or none is
+ */
+void vec_apply_permutation_all(
+        Vector* const vs,
+        const u64 count,
+        __restrict const cVector perm,
+        vec_err* __restrict const err
+        ){
+    if ( vs == NULL || perm == NULL || perm -> array == NULL ){
+        *err = null_vec_err;
+        return;
+    }
+    if ( count == 0 ){
+        *err = no_err;
+        return;
+    }
+    u64 es_max = 1;
+    for ( u64 c = 0; c < count; c++ ){
+        if ( vs[c] == NULL || vs[c] -> array == NULL ){
+            *err = null_vec_err;
+            return;
+        }
+        if ( perm -> element_size != sizeof(u64) || perm -> length != vs[c] -> length ){
+            *err = illegal_acces_err;
+            return;
+        }
+        if ( vs[c] -> element_size > es_max ) es_max = vs[c] -> element_size;
+    }
+    const u64 n = perm -> length;
+    const u64* const p = (const u64*)perm -> array;
+    const u64 words = n / 64 + 1;
+    u64* const seen = (u64*)calloc(words, sizeof(u64));
+    void* const tmp = malloc(es_max);
+    if ( seen == NULL || tmp == NULL ){
+        *err = alloc_err;
+        goto done;
+    }
+    for ( u64 i = 0; i < n; i++ ){
+        if ( p[i] >= n || ( seen[p[i] / 64] >> ( p[i] % 64 ) & 1 ) ){
+            *err = index_out_of_bounds_err;
+            goto done;
+        }
+        seen[p[i] / 64] |= 1UL << ( p[i] % 64 );
+    }
+    // unsharing leaves the elements as they are, a vector copied before a later failure is still intact
+    for ( u64 c = 0; c < count; c++ )
+        if ( in_vec_own(vs[c], err) != 0 ) goto done;
+    for ( u64 c = 0; c < count; c++ ){
+        const Vector v = vs[c];
+        const u64 es = v -> element_size;
+        memset(seen, 0, words * sizeof(u64));
+        for ( u64 start = 0; start < n; start++ ){
+            if ( seen[start / 64] >> ( start % 64 ) & 1 ) continue;
+            if ( p[start] == start ) continue;
+            memcpy(tmp, v -> array + start * es, es);
+            u64 j = start;
+            for ( ;; ){
+                seen[j / 64] |= 1UL << ( j % 64 );
+                const u64 k = p[j];
+                if ( k == start ){
+                    memcpy(v -> array + j * es, tmp, es);
+                    break;
+                }
+                memcpy(v -> array + j * es, v -> array + k * es, es);
+                j = k;
+            }
+        }
+        VEC_STAT(v, allocs, 2);
+        VEC_STAT(v, bytes_moved, n * es);
+    }
+    *err = no_err;
+done:
+    free(seen);
+    free(tmp);
+}
+
+void vec_apply_permutation(
+        Vector v,
+        __restrict const cVector perm,
+        vec_err* __restrict const err
+        ){
+    vec_apply_permutation_all(&v, 1, perm, err);
+}
+
+void vec_sort_by_key(
+        Vector v,
+        __restrict const cVector keys,
+        const CmpState(* const cmp)(const void* const, const void* const),
+        vec_err* __restrict const err
+        ){
+    if ( v == NULL || v -> array == NULL || keys == NULL || keys -> array == NULL ){
+        *err = null_vec_err;
+        return;
+    }
+    if ( keys -> length != v -> length ){
+        *err = illegal_acces_err;
+        return;
+    }
+    Vector perm = vec_argsort(keys, cmp, err);
+    if ( *err != no_err ) return;
+    vec_apply_permutation(v, perm, err);
+    vec_err ignored;
+    in_vec_destroy(perm, &ignored);
+}
+
+
+
+/*
+ *  selection
+ *  introselect: quickselect around the median of three with a hoare partition, which stops on elements equal
+ *  to the pivot and so splits runs of them evenly, after 2*log2(n) rounds the pivot becomes the median of the
+ *  medians of groups of five which bounds the remaining work to linear time. small ranges end in an insertion sort
+ */
+
+enum{
+    SELECT_SMALL = 16,
+};
+
+static inline void in_swap(void* const a, void* const b, void* const tmp, const u64 es){
+    memcpy(tmp, a, es);
+    memcpy(a, b, es);
+    memcpy(b, tmp, es);
+}
+
+static void in_insertion_sort(
+        void* const a,
+        const u64 lo,
+        const u64 hi,
+        const u64 es,
+        const CmpState(* const cmp)(const void* const, const void* const),
+        void* const tmp,
+        vec_stats* const tally
+        ){
+    for ( u64 i = lo + 1; i < hi; i++ ){
+        memcpy(tmp, a + i * es, es);
+        u64 j = i;
+        while ( j > lo ){
+            VEC_TALLY(tally, comparisons, 1);
+            if ( cmp(a + ( j - 1 ) * es, tmp) != sup ) break;
+            memcpy(a + j * es, a + ( j - 1 ) * es, es);
+            j --;
+        }
+        if ( j != i ) memcpy(a + j * es, tmp, es);
+    }
+}
+
+static inline u64 in_median3(
+        void* const a,
+        const u64 x,
+        const u64 y,
+        const u64 z,
+        const u64 es,
+        const CmpState(* const cmp)(const void* const, const void* const),
+        vec_stats* const tally
+        ){
+    VEC_TALLY(tally, comparisons, 3);
+    const int xy = cmp(a + x * es, a + y * es) == inf;
+    const int yz = cmp(a + y * es, a + z * es) == inf;
+    const int xz = cmp(a + x * es, a + z * es) == inf;
+    if ( xy == yz ) return y;
+    if ( xy == xz ) return z;
+    return x;
+}
+
+// puts in a[n] the element that would be there were [lo, hi) sorted, smaller ones before and greater ones after
+static void in_select(
+        void* const a,
+        u64 lo,
+        u64 hi,
+        const u64 n,
+        const u64 es,
+        const CmpState(* const cmp)(const void* const, const void* const),
+        void* const pivot,
+        void* const tmp,
+        u64 budget,
+        vec_stats* const tally
+        ){
+    while ( hi - lo > SELECT_SMALL ){
+        u64 p;
+        if ( budget > 0 ){
+            budget --;
+            p = in_median3(a, lo, lo + ( hi - lo ) / 2, hi - 1, es, cmp, tally);
+        }
+        else{
+            u64 groups = 0;
+            for ( u64 g = lo; g < hi; g += 5 ){
+                const u64 e = g + 5 < hi ? g + 5 : hi;
+                in_insertion_sort(a, g, e, es, cmp, tmp, tally);
+                in_swap(a + ( lo + groups ) * es, a + ( g + ( e - g ) / 2 ) * es, tmp, es);
+                groups ++;
+            }
+            in_select(a, lo, lo + groups, lo + groups / 2, es, cmp, pivot, tmp, 0, tally);
+            p = lo + groups / 2;
+        }
+        // with the pivot first the split j lands in [lo, hi - 1) and both sides shrink
+        if ( p != lo ) in_swap(a + lo * es, a + p * es, tmp, es);
+        memcpy(pivot, a + lo * es, es);
+        u64 i = lo - 1, j = hi;
+        for ( ;; ){
+            do{ i ++; VEC_TALLY(tally, comparisons, 1); } while ( cmp(a + i * es, pivot) == inf );
+            do{ j --; VEC_TALLY(tally, comparisons, 1); } while ( cmp(a + j * es, pivot) == sup );
+            if ( i >= j ) break;
+            in_swap(a + i * es, a + j * es, tmp, es);
+        }
+        if ( n <= j )   hi = j + 1;
+        else            lo = j + 1;
+    }
+    in_insertion_sort(a, lo, hi, es, cmp, tmp, tally);
+}
+
+static inline u64 in_select_budget(u64 n){
+    u64 depth = 0;
+    while ( n > 1 ){
+        n >>= 1;
+        depth += 2;
+    }
+    return depth;
+}
+
+// sorts a[0, n) in place by the max heap of cmp, tmp holds one element
+static void in_heap_sort(
+        void* const a,
+        const u64 n,
+        const u64 es,
+        const CmpState(* const cmp)(const void* const, const void* const),
+        const int reversed,
+        void* const tmp,
+        vec_stats* const tally
+        ){
+    if ( n < 2 ) return;
+    for ( u64 i = ( n - 2 ) / 2 + 1; i-- > 0; ){
+        memcpy(tmp, a + i * es, es);
+        in_heap_sift_down(a, n, i, tmp, es, cmp, reversed, 2, tally);
+    }
+    for ( u64 end = n - 1; end > 0; end-- ){
+        memcpy(tmp, a + end * es, es);
+        memcpy(a + end * es, a, es);
+        in_heap_sift_down(a, end, 0, tmp, es, cmp, reversed, 2, tally);
+    }
+}
+
+void vec_nth_element(
+        Vector v,
+        const u64 n,
+        const CmpState(* const cmp)(const void* const, const void* const),
+        vec_err* __restrict const err
+        ){
+    if ( v == NULL || v -> array == NULL ){
+        *err = null_vec_err;
+        return;
+    }
+    if ( n >= v -> length ){
+        *err = index_out_of_bounds_err;
+        return;
+    }
+    if ( in_vec_own(v, err) != 0 ) return;
+    void* const buf = malloc(2 * v -> element_size);
+    if ( buf == NULL ){
+        *err = alloc_err;
+        return;
+    }
+    vec_stats tally = { 0 };
+    in_select(
+        v -> array, 0, v -> length, n, v -> element_size, cmp,
+        buf, buf + v -> element_size, in_select_budget(v -> length), &tally
+    );
+    free(buf);
+    VEC_STAT(v, allocs, 1);
+    in_sort_tally(v, &tally);
+    *err = no_err;
+}
+
+void vec_partial_sort(
+        Vector v,
+        const u64 k,
+        const CmpState(* const cmp)(const void* const, const void* const),
+        vec_err* __restrict const err
+        ){
+    if ( v == NULL || v -> array == NULL ){
+        *err = null_vec_err;
+        return;
+    }
+    if ( k > v -> length ){
+        *err = index_out_of_bounds_err;
+        return;
+    }
+    if ( in_vec_own(v, err) != 0 ) return;
+    *err = no_err;
+    if ( k == 0 ) return;
+    void* const buf = malloc(2 * v -> element_size);
+    if ( buf == NULL ){
+        *err = alloc_err;
+        return;
+    }
+    vec_stats tally = { 0 };
+    u64 sorted = k;
+    if ( k < v -> length ){
+        in_select(
+            v -> array, 0, v -> length, k - 1, v -> element_size, cmp,
+            buf, buf + v -> element_size, in_select_budget(v -> length), &tally
+        );
+        sorted = k - 1;
+    }
+    in_heap_sort(v -> array, sorted, v -> element_size, cmp, 0, buf, &tally);
+    free(buf);
+    VEC_STAT(v, allocs, 1);
+    in_sort_tally(v, &tally);
+}
+
+Vector vec_top_k(
+        __restrict const cVector v,
+        const u64 k,
+        const CmpState(* const cmp)(const void* const, const void* const),
+        vec_err* __restrict const err
+        ){
+    if ( v == NULL || v -> array == NULL ){
+        *err = null_vec_err;
+        return NULL;
+    }
+    // a min heap of the k greatest elements seen so far, its top is the one to evict
+    const u64 es = v -> element_size;
+    Vector out = in_vec_init(es, k, err);
+    if ( *err != no_err ) return NULL;
+    void* const tmp = malloc(es != 0 ? es : 1);
+    if ( tmp == NULL ){
+        vec_err ignored;
+        in_vec_destroy(out, &ignored);
+        *err = alloc_err;
+        return NULL;
+    }
+    vec_stats tally = { 0 };
+    for ( u64 i = 0; i < v -> length && k > 0; i++ ){
+        const void* const x = v -> array + i * es;
+        if ( out -> length < k ){
+            in_heap_sift_up(out -> array, out -> length, x, es, cmp, 1, 2, &tally);
+            out -> length ++;
+            continue;
+        }
+        VEC_TALLY(&tally, comparisons, 1);
+        if ( cmp(x, out -> array) == sup )
+            in_heap_sift_down(out -> array, k, 0, x, es, cmp, 1, 2, &tally);
+    }
+    in_heap_sort(out -> array, out -> length, es, cmp, 1, tmp, &tally);
+    free(tmp);
+    VEC_STAT(v, allocs, 1);
+    VEC_STAT(v, bytes_copied, out -> length * es);
+    in_sort_tally(v, &tally);
+    *err = no_err;
+    return out;
+}
+
+
+
+/*
+ *  hashing
+ *  in_htab maps elements to u64 values with open addressing and linear probing over one flat array of
+ *  { hash, value + 1 } slots, 0 marking an empty one. it never holds elements itself, key_of gives back
+ *  the element a value stands for, and the stored hashes spare rehashing on growth and most comparisons
+ */
+
+typedef struct{
+    u64 hash;
+    u64 value;
+} in_slot;
+
+typedef struct{
+    in_slot*    slots;
+    u64         mask;
+    u64         count;
+    u64         element_size;
+    u64         (* hash)(const void* const, void* const);
+    int         (* eq)(const void* const, const void* const, void* const);
+    void*       ctx;
+    const void* (* key_of)(const void* const, const u64);
+    const void* owner;
+} in_htab;
+
+static u64 in_hash_bytes(const void* const key, const u64 length){
+    u64 h = 0x9E3779B97F4A7C15UL ^ length;
+    u64 i = 0;
+    for ( ; i + 8 <= length; i += 8 ){
+        u64 w;
+        memcpy(&w, key + i, 8);
+        h = ( h ^ w ) * 0xBF58476D1CE4E5B9UL;
+        h ^= h >> 31;
+    }
+    if ( i < length ){
+        u64 w = 0;
+        memcpy(&w, key + i, length - i);
+        h = ( h ^ w ) * 0xBF58476D1CE4E5B9UL;
+    }
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDUL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53UL;
+    h ^= h >> 33;
+    return h;
+}
+
+static inline u64 in_htab_hash(const in_htab* const t, const void* const key){
+    return t -> hash != NULL ? t -> hash(key, t -> ctx) : in_hash_bytes(key, t -> element_size);
+}
+
+static inline int in_htab_eq(const in_htab* const t, const void* const a, const void* const b){
+    return t -> eq != NULL ? t -> eq(a, b, t -> ctx) : memcmp(a, b, t -> element_size) == 0;
+}
+
+static int in_htab_init(
+        in_htab* const t,
+        const u64 element_size,
+        u64 (* const hash)(const void* const, void* const),
+        int (* const eq)(const void* const, const void* const, void* const),
+        void* const ctx,
+        const void* (* const key_of)(const void* const, const u64),
+        const void* const owner
+        ){
+    t -> mask = 15;
+    t -> count = 0;
+    t -> slots = (in_slot*)calloc(t -> mask + 1, sizeof(in_slot));
+    t -> element_size = element_size;
+    t -> hash = hash;
+    t -> eq = eq;
+    t -> ctx = ctx;
+    t -> key_of = key_of;
+    t -> owner = owner;
+    return t -> slots == NULL ? -1 : 0;
+}
+
+static inline void in_htab_free(in_htab* const t){
+    free(t -> slots);
+    t -> slots = NULL;
+}
+
+static int in_htab_grow(in_htab* const t){
+    const u64 mask = t -> mask * 2 + 1;
+    in_slot* const slots = (in_slot*)calloc(mask + 1, sizeof(in_slot));
+    if ( slots == NULL ) return -1;
+    for ( u64 i = 0; i <= t -> mask; i++ ){
+        if ( t -> slots[i].value == 0 ) continue;
+        u64 j = t -> slots[i].hash & mask;
+        while ( slots[j].value != 0 ) j = ( j + 1 ) & mask;
+        slots[j] = t -> slots[i];
+    }
+    free(t -> slots);
+    t -> slots = slots;
+    t -> mask = mask;
+    return 0;
+}
+
+// the value of an element equal to key, or value after storing it for key, UINT64_MAX when growing failed
+static u64 in_htab_find_or_insert(in_htab* const t, const void* const key, const u64 value){
+    if ( 2 * ( t -> count + 1 ) > t -> mask + 1 && in_htab_grow(t) != 0 )
+        return UINT64_MAX;
+    const u64 h = in_htab_hash(t, key);
+    u64 i = h & t -> mask;
+    while ( t -> slots[i].value != 0 ){
+        if ( t -> slots[i].hash == h && in_htab_eq(t, t -> key_of(t -> owner, t -> slots[i].value - 1), key) )
+            return t -> slots[i].value - 1;
+        i = ( i + 1 ) & t -> mask;
+    }
+    t -> slots[i].hash = h;
+    t -> slots[i].value = value + 1;
+    t -> count ++;
+    return value;
+}
+
+void vec_dedup_sorted(
+        Vector v,
+        const CmpState(* const cmp)(const void* const, const void* const),
+        vec_err* __restrict const err
+        ){
+    if ( v == NULL || v -> array == NULL ){
+        *err = null_vec_err;
+        return;
+    }
+    *err = no_err;
+    if ( v -> length < 2 ) return;
+    if ( in_vec_own(v, err) != 0 ) return;
+    const u64 es = v -> element_size;
+    u64 kept = 1;
+    for ( u64 i = 1; i < v -> length; i++ ){
+        const void* const last = v -> array + ( kept - 1 ) * es;
+        const void* const x = v -> array + i * es;
+        if ( cmp != NULL ? cmp(last, x) == eq : memcmp(last, x, es) == 0 ) continue;
+        if ( kept != i ) memcpy(v -> array + kept * es, x, es);
+        kept ++;
+    }
+    VEC_STAT(v, bytes_copied, ( kept - 1 ) * es);
+    v -> length = kept;
+}
+
+typedef struct{
+    cVector v;
+    Vector  firsts;
+} in_grouping;
+
+static const void* in_group_key(const void* const owner, const u64 group){
+    const in_grouping* const g = (const in_grouping*)owner;
+    return g -> v -> array + ((u64*)g -> firsts -> array)[group] * g -> v -> element_size;
+}
+
+/*
+ *  one pass over v numbering the groups of equal elements in order of first appearance, firsts gets the index
+ *  of the first element of every group, counts, when given, their sizes and ids, when given with a capacity of
+ *  at least the length of v, the group of every element
+ */
+static void in_group(
+        __restrict const cVector v,
+        u64 (* const hash)(const void* const, void* const),
+        int (* const eq)(const void* const, const void* const, void* const),
+        void* const ctx,
+        Vector firsts,
+        Vector counts,
+        Vector ids,
+        vec_err* __restrict const err
+        ){
+    in_grouping grouping = { v, firsts };
+    in_htab t;
+    if ( in_htab_init(&t, v -> element_size, hash, eq, ctx, in_group_key, &grouping) != 0 ){
+        *err = alloc_err;
+        return;
+    }
+    *err = no_err;
+    for ( u64 i = 0; i < v -> length; i++ ){
+        const u64 fresh = firsts -> length;
+        const u64 group = in_htab_find_or_insert(&t, v -> array + i * v -> element_size, fresh);
+        if ( group == UINT64_MAX ){
+            *err = alloc_err;
+            break;
+        }
+        if ( ids != NULL ){
+            ((u64*)ids -> array)[i] = group;
+            ids -> length ++;
+        }
+        if ( group == fresh ){
+            in_vec_push(firsts, &i, err);
+            if ( *err != no_err ) break;
+            if ( counts != NULL ){
+                const u64 one = 1;
+                in_vec_push(counts, &one, err);
+                if ( *err != no_err ) break;
+            }
+        }
+        else if ( counts != NULL )
+            ((u64*)counts -> array)[group] ++;
+    }
+    VEC_STAT(v, allocs, 1);
+    in_htab_free(&t);
+}
+
+Vector vec_unique(
+        __restrict const cVector v,
+        u64 (* const hash)(const void* const, void* const),
+        int (* const eq)(const void* const, const void* const, void* const),
+        void* const ctx,
+        vec_err* __restrict const err
+        ){
+    if ( v == NULL || v -> array == NULL ){
+        *err = null_vec_err;
+        return NULL;
+    }
+    vec_err ignored;
+    Vector firsts = in_vec_init(sizeof(u64), 0, err);
+    if ( *err != no_err ) return NULL;
+    in_group(v, hash, eq, ctx, firsts, NULL, NULL, err);
+    if ( *err != no_err ){
+        in_vec_destroy(firsts, &ignored);
+        return NULL;
+    }
+    Vector out = in_vec_init(v -> element_size, firsts -> length, err);
+    if ( *err != no_err ){
+        in_vec_destroy(firsts, &ignored);
+        return NULL;
+    }
+    const u64* const index = (const u64*)firsts -> array;
+    for ( u64 g = 0; g < firsts -> length; g++ )
+        memcpy(
+            out -> array + g * v -> element_size,
+            v -> array + index[g] * v -> element_size,
+            v -> element_size
+        );
+    out -> length = firsts -> length;
+    VEC_STAT(out, bytes_copied, out -> length * v -> element_size);
+    in_vec_destroy(firsts, &ignored);
+    return out;
+}
+
+Vector vec_group_by(
+        __restrict const cVector v,
+        u64 (* const hash)(const void* const, void* const),
+        int (* const eq)(const void* const, const void* const, void* const),
+        void* const ctx,
+        Vector* const counts,
+        Vector* const ids,
+        vec_err* __restrict const err
+        ){
+    if ( v == NULL || v -> array == NULL ){
+        *err = null_vec_err;
+        return NULL;
+    }
+    vec_err ignored;
+    Vector firsts = in_vec_init(sizeof(u64), 0, err);
+    if ( *err != no_err ) return NULL;
+    Vector sizes = NULL;
+    Vector groups = NULL;
+    if ( counts != NULL ){
+        sizes = in_vec_init(sizeof(u64), 0, err);
+        if ( *err != no_err ) goto failure;
+    }
+    if ( ids != NULL ){
+        groups = in_vec_init(sizeof(u64), v -> length, err);
+        if ( *err != no_err ) goto failure;
+    }
+    in_group(v, hash, eq, ctx, firsts, sizes, groups, err);
+    if ( *err != no_err ) goto failure;
+    if ( counts != NULL ) *counts = sizes;
+    if ( ids != NULL ) *ids = groups;
+    return firsts;
+failure:
+    in_vec_destroy(firsts, &ignored);
+    if ( sizes != NULL ) in_vec_destroy(sizes, &ignored);
+    if ( groups != NULL ) in_vec_destroy(groups, &ignored);
+    if ( counts != NULL ) *counts = NULL;
+    if ( ids != NULL ) *ids = NULL;
+    return NULL;
+}
@@ -6,6 +6,66 @@
  *  to panic at the error with the implemented vec_panic or handle the error by himself, or ignore it at all ( which is not 
  *  recommanded )
  *  
+ *  storage:
+ *  vec_init_aligned_ gives an array aligned to VEC_CACHE_LINE or to a caller chosen power of two, kept on growth.
+ *  on linux once such an array reaches VEC_HUGE_THRESHOLD bytes ( 2MiB unless overridden at build time ) it is
+ *  mmap'd, advised to huge pages and grown through mremap instead of being copied. this only applies to aligned
+ *  vectors whose alignment is at most the page size, plain and over aligned ones stay on the heap
+ *
+ *  gap vectors:
+ *  a GapVector holds the same elements as a Vector around a movable gap left at the last edit, so inserts and
+ *  removals clustered around a cursor only move the elements between two consecutive edits instead of the whole
+ *  tail. gvec_from_vec and gvec_into_vec convert from and to a contiguous Vector, taking over its array
+ *
+ *  flat sets:
+ *  a FlatSet keeps unique elements sorted in a Vector by a CmpState comparator, searches return indexes into it
+ *  ( the length when absent ) without copying. fset_insert_many_ sorts a batch and merges it in one linear pass.
+ *  a flat map is a FlatSet of records whose comparator only looks at the key, fset_upsert_ overwrites the value.
+ *  the fset_eytzinger layout also keeps a breadth first copy for branch free searches on read mostly sets, rebuilt
+ *  by every modification so that searches only read and may run from several threads between modifications
+ *
+ *  heaps:
+ *  vec_make_heap and vec_heap_* keep a Vector as a max heap in place, the top being the greatest element for the
+ *  CmpState comparator. arity picks a binary ( 0 or 2 ) or a wider layout, 4 keeps the children of a node on the
+ *  same cache line for small elements. the typed vec_*heap*_T variants work straight on the T array
+ *
+ *  struct of arrays:
+ *  GENERIC_SOA(S, FIELDS) keeps records in one Vector per field so that a scan over a field only reads that field.
+ *  the fields are given as an X macro of arithmetic members, e.g.
+ *      #define POINT(X, S) X(S, float, x) X(S, float, y) X(S, int, id)
+ *      GENERIC_SOA(point, POINT)
+ *  gives point_row, point_soa and soa_{init,destroy,len,push,get,filter,from_vec,to_vec}_point, plus per field
+ *  soa_sort_by_point_x, a stable sort permuting every column in place, and the reductions soa_{sum,min,max}_point_x
+ *
+ *  pipelines:
+ *  a Pipeline over a Vector, a range of one or a raw array only records its map, filter, take and zip stages,
+ *  pipe_collect_ and pipe_fold_ then run all of them element by element in a single pass with no intermediate
+ *  Vector. pipe_collect_par_ runs the same pass on chunks of the input in several threads ( link with -pthread ).
+ *  a source Vector is read as it is when running, truncated to its current length if it shrank since
+ *
+ *  copies:
+ *  vec_clone is a deep copy made with a single memcpy. vec_share returns a new handle on the same array in O(1),
+ *  the first write through any of the handles ( push, insert, remove, heaps, vec_data_ ... ) copies the array
+ *  for that handle only and the array goes away with its last handle, vec_cdata_ gives read only access without
+ *  copying. several threads may vec_share the same vector at once, provided none of them writes through it
+ *
+ *  orderings:
+ *  vec_stable_sort_ is a merge sort keeping equal elements in order. vec_argsort returns the u64 indexes that
+ *  would sort a vector, vec_apply_permutation reorders a vector in place so that v[i] becomes v[perm[i]], and
+ *  vec_sort_by_key combines both to reorder a payload by a separate vector of keys without moving wide records
+ *  more than once. vec_apply_permutation_all reorders several vectors, the columns of a GENERIC_SOA, all or none
+ *
+ *  selection:
+ *  vec_nth_element puts in place the element of rank n with smaller ones before it and greater ones after, in
+ *  linear time even on sorted or repetitive input. vec_partial_sort sorts the k smallest at the front and
+ *  vec_top_k returns the k greatest, greatest first, through a bounded heap in a single pass over the input
+ *
+ *  deduplication:
+ *  vec_dedup_sorted drops adjacent duplicates in place. vec_unique keeps the first occurrence of every element
+ *  and vec_group_by returns the index of the first element of every group of equal ones with, in counts, the
+ *  size of each group and, in ids, the group of every element ( either may be NULL ). both hash the elements, by
+ *  their bytes or by a hash and equality taking a context, in a single pass and keep the order of first appearance
+ *
  *  apart of a constructor and destructor, methods are implemented which are:
  *  basic:
  *  - access: get, first, last ...
@@ -19,6 +79,11 @@
  *  - copying
  *  - printing
  *
+ *  instrumentation:
+ *  building vector.c with -DVEC_STATS turns on counters for allocations, reallocations, bytes copied and moved,
+ *  comparisons made by the sorts and peak capacity, both per vector and globally, readable through vec_stats_*.
+ *  without the flag the counters are compiled out and vec_stats_* report zeros
+ *
  *  aside from the generic interface presented thanks to the use of void pointers, we have just below it an other interface
  *  a more user friendly one which manages genericity gracefully with the appending of the generic typing to the method's name
  *  ( replace <T> or ::<T> with _T in the method name ) to further abstract away the memory management for 
@@ -36,8 +101,16 @@
 
 
 typedef uint64_t u64;
+
+#define VEC_CACHE_LINE 64
 typedef struct vector* Vector;
 typedef struct vector* const cVector;
+typedef struct gap_vector* GapVector;
+typedef struct gap_vector* const cGapVector;
+typedef struct flat_set* FlatSet;
+typedef struct flat_set* const cFlatSet;
+typedef struct pipeline* Pipeline;
+typedef struct pipeline* const cPipeline;
 
 typedef enum{
     no_err,
@@ -47,15 +120,32 @@ typedef enum{
     illegal_del_err,
     illegal_acces_err,
     index_out_of_bounds_err,
+    illegal_align_err,
 } vec_err;
 
+typedef struct{
+    u64 allocs;
+    u64 reallocs;
+    u64 bytes_copied;
+    u64 bytes_moved;
+    u64 comparisons;
+    u64 sorts;
+    u64 peak_bytes;
+} vec_stats;
+
 typedef enum{
     inf = -1,
     eq  =  0,
     sup =  1
 } CmpState;
 
+typedef enum{
+    fset_sorted,
+    fset_eytzinger,
+} fset_layout;
+
 Vector   vec_init_(u64 element_size, u64 def_capa, vec_err* __restrict const err);
+Vector   vec_init_aligned_(u64 element_size, u64 def_capa, u64 alignment, vec_err* __restrict const err);
 void     vec_destroy(Vector v, vec_err* __restrict const err);
 void     vec_push_(Vector v, const void* const element, vec_err* const err);
 void*    vec_pop_(cVector const v, vec_err* __restrict const err);
@@ -68,18 +158,291 @@ void*    vec_first_(__restrict const cVector v, vec_err* __restrict const err);
 void*    vec_last_(__restrict const cVector v, vec_err* __restrict const err);
 Vector   vec_map_(const u64 out_element_size, __restrict const cVector v, const void*(* const function)(void*), vec_err* __restrict const err);
 Vector   vec_sort_(__restrict const cVector v, const CmpState(*const cmp)(const void* const, const void* const), vec_err* __restrict const err);
+Vector   vec_stable_sort_(__restrict const cVector v, const CmpState(*const cmp)(const void* const, const void* const), vec_err* __restrict const err);
+Vector   vec_argsort(__restrict const cVector v, const CmpState(*const cmp)(const void* const, const void* const), vec_err* __restrict const err);
+void     vec_sort_by_key(Vector v, __restrict const cVector keys, const CmpState(*const cmp)(const void* const, const void* const), vec_err* __restrict const err);
+void     vec_apply_permutation(Vector v, __restrict const cVector perm, vec_err* __restrict const err);
+void     vec_apply_permutation_all(Vector* const vs, const u64 count, __restrict const cVector perm, vec_err* __restrict const err);
 Vector   vec_reverse(__restrict const cVector v, vec_err* __restrict const err);
 Vector   vec_subvec(__restrict const cVector v, const u64 b, const u64 e, vec_err* __restrict const err);
+Vector   vec_clone(__restrict const cVector v, vec_err* __restrict const err);
+Vector   vec_share(__restrict const cVector v, vec_err* __restrict const err);
+void*    vec_data_(__restrict const cVector v, vec_err* __restrict const err);
+const void* vec_cdata_(__restrict const cVector v, vec_err* __restrict const err);
+void     vec_truncate(cVector v, const u64 length, vec_err* __restrict const err);
 void     vec_panic(const vec_err);
 
+// heaps
+
+void     vec_make_heap(Vector v, const CmpState(* const cmp)(const void* const, const void* const), u64 arity, vec_err* __restrict const err);
+void     vec_heap_push(Vector v, const void* const element, const CmpState(* const cmp)(const void* const, const void* const), u64 arity, vec_err* __restrict const err);
+void     vec_heap_pop_into(Vector v, void* const out, const CmpState(* const cmp)(const void* const, const void* const), u64 arity, vec_err* __restrict const err);
+void     vec_heap_replace_top(Vector v, const void* const element, void* const out, const CmpState(* const cmp)(const void* const, const void* const), u64 arity, vec_err* __restrict const err);
+
+// selection
+
+void     vec_nth_element(Vector v, const u64 n, const CmpState(* const cmp)(const void* const, const void* const), vec_err* __restrict const err);
+void     vec_partial_sort(Vector v, const u64 k, const CmpState(* const cmp)(const void* const, const void* const), vec_err* __restrict const err);
+Vector   vec_top_k(__restrict const cVector v, const u64 k, const CmpState(* const cmp)(const void* const, const void* const), vec_err* __restrict const err);
+
+// deduplication and grouping, a NULL comparator, hash or equality works on the bytes of the elements
+
+void     vec_dedup_sorted(Vector v, const CmpState(* const cmp)(const void* const, const void* const), vec_err* __restrict const err);
+Vector   vec_unique(__restrict const cVector v, u64 (* const hash)(const void* const, void* const), int (* const eq)(const void* const, const void* const, void* const), void* const ctx, vec_err* __restrict const err);
+Vector   vec_group_by(__restrict const cVector v, u64 (* const hash)(const void* const, void* const), int (* const eq)(const void* const, const void* const, void* const), void* const ctx, Vector* const counts, Vector* const ids, vec_err* __restrict const err);
+
 void     vec_print_(const __restrict cVector v, void (* const printer )(const void* const));
 
+// gap vectors, gvec_from_vec and gvec_into_vec consume their argument
+
+GapVector gvec_init_(u64 element_size, u64 def_capa, vec_err* __restrict const err);
+GapVector gvec_from_vec(Vector v, vec_err* __restrict const err);
+Vector    gvec_into_vec(GapVector g, vec_err* __restrict const err);
+void      gvec_destroy(GapVector g, vec_err* __restrict const err);
+u64       gvec_len(__restrict const cGapVector g, vec_err* __restrict const err);
+void      gvec_push_(GapVector g, const void* const element, vec_err* __restrict const err);
+void      gvec_insert_(GapVector g, const void* const element, const u64 index, vec_err* __restrict const err);
+void*     gvec_remove_(GapVector g, const u64 index, vec_err* __restrict const err);
+void*     gvec_get_(__restrict const cGapVector g, const u64 index, vec_err* __restrict const err);
+void      gvec_foreach_(__restrict const cGapVector g, void (* const function)(const void* const));
+
+// flat sets, indexes returned by the searches and pointers from fset_at_ hold until the next modification
+
+FlatSet     fset_init_(u64 element_size, u64 def_capa, const CmpState(* const cmp)(const void* const, const void* const), const fset_layout layout, vec_err* __restrict const err);
+void        fset_destroy(FlatSet s, vec_err* __restrict const err);
+u64         fset_len(__restrict const cFlatSet s, vec_err* __restrict const err);
+const void* fset_at_(__restrict const cFlatSet s, const u64 index, vec_err* __restrict const err);
+u64         fset_find_(__restrict const cFlatSet s, const void* const key, vec_err* __restrict const err);
+u64         fset_lower_bound_(__restrict const cFlatSet s, const void* const key, vec_err* __restrict const err);
+Vector      fset_range_(__restrict const cFlatSet s, const void* const lo, const void* const hi, vec_err* __restrict const err);
+int         fset_insert_(FlatSet s, const void* const element, vec_err* __restrict const err);
+int         fset_upsert_(FlatSet s, const void* const element, vec_err* __restrict const err);
+u64         fset_insert_many_(FlatSet s, __restrict const cVector batch, vec_err* __restrict const err);
+int         fset_erase_(FlatSet s, const void* const key, vec_err* __restrict const err);
+cVector     fset_items(__restrict const cFlatSet s, vec_err* __restrict const err);
+
+// pipelines, the stages run in the order they are added, maps and zips write their result in the out pointer
+
+Pipeline pipe_from_(__restrict const cVector v, vec_err* __restrict const err);
+Pipeline pipe_from_range_(__restrict const cVector v, const u64 b, const u64 e, vec_err* __restrict const err);
+Pipeline pipe_from_view_(const void* const data, const u64 length, const u64 element_size, vec_err* __restrict const err);
+void     pipe_destroy(Pipeline p, vec_err* __restrict const err);
+void     pipe_map_(Pipeline p, const u64 out_element_size, void (* const function)(const void* const, void* const), vec_err* __restrict const err);
+void     pipe_filter_(Pipeline p, int (* const predicate)(const void* const), vec_err* __restrict const err);
+void     pipe_take_(Pipeline p, const u64 n, vec_err* __restrict const err);
+void     pipe_zip_(Pipeline p, __restrict const cVector other, const u64 out_element_size, void (* const function)(const void* const, const void* const, void* const), vec_err* __restrict const err);
+Vector   pipe_collect_(__restrict const cPipeline p, vec_err* __restrict const err);
+Vector   pipe_collect_par_(__restrict const cPipeline p, u64 threads, vec_err* __restrict const err);
+void     pipe_fold_(__restrict const cPipeline p, void* const acc, void (* const function)(void* const, const void* const), vec_err* __restrict const err);
+
+// instrumentation, only counts when vector.c is built with -DVEC_STATS
+
+vec_stats vec_stats_of(__restrict const cVector v, vec_err* __restrict const err);
+vec_stats vec_stats_global(void);
+void      vec_stats_reset(cVector v, vec_err* __restrict const err);
+void      vec_stats_reset_global(void);
+void      vec_stats_print(const __restrict cVector v);
+void      vec_stats_dump(void);
+void      vec_stats_dump_at_exit(void);
+
 // a front end for the ease of use
 
+#define GENERIC_VEC_HEAP(T)                                                                                         \
+    inline CmpState vec_heap_cmp_##T(const CmpState(*const cmp)(const T, const T), const int reversed,              \
+            const T a, const T b){                                                                                  \
+        return reversed ? cmp(b, a) : cmp(a, b);                                                                    \
+    }                                                                                                               \
+    inline void   vec_heap_sift_up_##T(T* const a, u64 hole, const T x,                                             \
+            const CmpState(*const cmp)(const T, const T), const int reversed, const u64 d){                         \
+        while ( hole > 0 ){                                                                                         \
+            const u64 parent = ( hole - 1 ) / d;                                                                    \
+            if ( vec_heap_cmp_##T(cmp, reversed, a[parent], x) != inf ) break;                                      \
+            a[hole] = a[parent];                                                                                    \
+            hole = parent;                                                                                          \
+        }                                                                                                           \
+        a[hole] = x;                                                                                                \
+    }                                                                                                               \
+    inline void   vec_heap_sift_down_##T(T* const a, const u64 n, u64 hole, const T x,                              \
+            const CmpState(*const cmp)(const T, const T), const int reversed, const u64 d){                         \
+        for ( ;; ){                                                                                                 \
+            const u64 first = hole * d + 1;                                                                         \
+            if ( first >= n ) break;                                                                                \
+            const u64 last = first + d < n ? first + d : n;                                                         \
+            u64 best = first;                                                                                       \
+            for ( u64 c = first + 1; c < last; c++ )                                                                \
+                if ( vec_heap_cmp_##T(cmp, reversed, a[c], a[best]) == sup ) best = c;                              \
+            if ( vec_heap_cmp_##T(cmp, reversed, a[best], x) != sup ) break;                                        \
+            a[hole] = a[best];                                                                                      \
+            hole = best;                                                                                            \
+        }                                                                                                           \
+        a[hole] = x;                                                                                                \
+    }                                                                                                               \
+    inline void   vec_make_heap_##T(Vector v, const CmpState(*const cmp)(const T, const T),                         \
+            u64 arity, vec_err* __restrict const err){                                                              \
+        T* const a = (T*)vec_data_(v, err);                                                                         \
+        if ( a == NULL ) return;                                                                                    \
+        const u64 n = vec_len(v, err);                                                                              \
+        arity = arity < 2 ? 2 : arity;                                                                              \
+        if ( n < 2 ) return;                                                                                        \
+        for ( u64 i = ( n - 2 ) / arity + 1; i-- > 0; )                                                             \
+            vec_heap_sift_down_##T(a, n, i, a[i], cmp, 0, arity);                                                   \
+    }                                                                                                               \
+    inline void   vec_heap_push_##T(Vector v, const T element, const CmpState(*const cmp)(const T, const T),        \
+            u64 arity, vec_err* __restrict const err){                                                              \
+        vec_push_(v, (void*)&(T){element}, err);                                                                    \
+        if ( *err != no_err ) return;                                                                               \
+        T* const a = (T*)vec_data_(v, err);                                                                         \
+        vec_heap_sift_up_##T(a, vec_len(v, err) - 1, element, cmp, 0, arity < 2 ? 2 : arity);                       \
+    }                                                                                                               \
+    inline T      vec_heap_pop_##T(Vector v, const CmpState(*const cmp)(const T, const T),                          \
+            u64 arity, vec_err* __restrict const err){                                                              \
+        T* const a = (T*)vec_data_(v, err);                                                                         \
+        if ( a == NULL ) return (T)0;                                                                               \
+        const u64 n = vec_len(v, err);                                                                              \
+        if ( n == 0 ){                                                                                              \
+            *err = illegal_del_err;                                                                                 \
+            return (T)0;                                                                                            \
+        }                                                                                                           \
+        const T output = a[0];                                                                                      \
+        vec_truncate(v, n - 1, err);                                                                                \
+        if ( n > 1 ) vec_heap_sift_down_##T(a, n - 1, 0, a[n - 1], cmp, 0, arity < 2 ? 2 : arity);                  \
+        return output;                                                                                              \
+    }                                                                                                               \
+    inline T      vec_heap_replace_top_##T(Vector v, const T element, const CmpState(*const cmp)(const T, const T), \
+            u64 arity, vec_err* __restrict const err){                                                              \
+        T* const a = (T*)vec_data_(v, err);                                                                         \
+        if ( a == NULL ) return (T)0;                                                                               \
+        const u64 n = vec_len(v, err);                                                                              \
+        if ( n == 0 ){                                                                                              \
+            *err = illegal_acces_err;                                                                               \
+            return (T)0;                                                                                            \
+        }                                                                                                           \
+        const T output = a[0];                                                                                      \
+        vec_heap_sift_down_##T(a, n, 0, element, cmp, 0, arity < 2 ? 2 : arity);                                    \
+        return output;                                                                                              \
+    }
+
+#define GENERIC_VEC_SELECT(T)                                                                                       \
+    inline void   vec_insertion_sort_##T(T* const a, const u64 lo, const u64 hi,                                    \
+            const CmpState(*const cmp)(const T, const T)){                                                          \
+        for ( u64 i = lo + 1; i < hi; i++ ){                                                                        \
+            const T x = a[i];                                                                                       \
+            u64 j = i;                                                                                              \
+            for ( ; j > lo && cmp(a[j - 1], x) == sup; j-- ) a[j] = a[j - 1];                                       \
+            a[j] = x;                                                                                               \
+        }                                                                                                           \
+    }                                                                                                               \
+    void   vec_select_##T(T* const a, u64 lo, u64 hi, const u64 n,                                                  \
+            const CmpState(*const cmp)(const T, const T), u64 budget){                                              \
+        while ( hi - lo > 16 ){                                                                                     \
+            u64 p;                                                                                                  \
+            if ( budget > 0 ){                                                                                      \
+                budget --;                                                                                          \
+                const u64 x = lo, y = lo + ( hi - lo ) / 2, z = hi - 1;                                             \
+                const int xy = cmp(a[x], a[y]) == inf, yz = cmp(a[y], a[z]) == inf, xz = cmp(a[x], a[z]) == inf;    \
+                p = xy == yz ? y : xy == xz ? z : x;                                                                \
+            }                                                                                                       \
+            else{                                                                                                   \
+                u64 groups = 0;                                                                                     \
+                for ( u64 g = lo; g < hi; g += 5 ){                                                                 \
+                    const u64 e = g + 5 < hi ? g + 5 : hi;                                                          \
+                    vec_insertion_sort_##T(a, g, e, cmp);                                                           \
+                    const T median = a[g + ( e - g ) / 2];                                                          \
+                    a[g + ( e - g ) / 2] = a[lo + groups];                                                          \
+                    a[lo + groups] = median;                                                                        \
+                    groups ++;                                                                                      \
+                }                                                                                                   \
+                vec_select_##T(a, lo, lo + groups, lo + groups / 2, cmp, 0);                                        \
+                p = lo + groups / 2;                                                                                \
+            }                                                                                                       \
+            const T pivot = a[p];                                                                                   \
+            a[p] = a[lo];                                                                                           \
+            a[lo] = pivot;                                                                                          \
+            u64 i = lo - 1, j = hi;                                                                                 \
+            for ( ;; ){                                                                                             \
+                do i ++; while ( cmp(a[i], pivot) == inf );                                                         \
+                do j --; while ( cmp(a[j], pivot) == sup );                                                         \
+                if ( i >= j ) break;                                                                                \
+                const T t = a[i]; a[i] = a[j]; a[j] = t;                                                            \
+            }                                                                                                       \
+            if ( n <= j )   hi = j + 1;                                                                             \
+            else            lo = j + 1;                                                                             \
+        }                                                                                                           \
+        vec_insertion_sort_##T(a, lo, hi, cmp);                                                                     \
+    }                                                                                                               \
+    inline void   vec_heap_sort_##T(T* const a, const u64 n, const CmpState(*const cmp)(const T, const T),          \
+            const int reversed){                                                                                    \
+        if ( n < 2 ) return;                                                                                        \
+        for ( u64 i = ( n - 2 ) / 2 + 1; i-- > 0; )                                                                 \
+            vec_heap_sift_down_##T(a, n, i, a[i], cmp, reversed, 2);                                                \
+        for ( u64 end = n - 1; end > 0; end-- ){                                                                    \
+            const T x = a[end];                                                                                     \
+            a[end] = a[0];                                                                                          \
+            vec_heap_sift_down_##T(a, end, 0, x, cmp, reversed, 2);                                                 \
+        }                                                                                                           \
+    }                                                                                                               \
+    inline void   vec_nth_element_##T(Vector v, const u64 n, const CmpState(*const cmp)(const T, const T),          \
+            vec_err* __restrict const err){                                                                         \
+        const u64 length = vec_len(v, err);                                                                         \
+        if ( *err != no_err ) return;                                                                               \
+        if ( n >= length ){                                                                                         \
+            *err = index_out_of_bounds_err;                                                                         \
+            return;                                                                                                 \
+        }                                                                                                           \
+        T* const a = (T*)vec_data_(v, err);                                                                         \
+        if ( a == NULL ) return;                                                                                    \
+        u64 budget = 0;                                                                                             \
+        for ( u64 m = length; m > 1; m >>= 1 ) budget += 2;                                                         \
+        vec_select_##T(a, 0, length, n, cmp, budget);                                                               \
+    }                                                                                                               \
+    inline void   vec_partial_sort_##T(Vector v, const u64 k, const CmpState(*const cmp)(const T, const T),         \
+            vec_err* __restrict const err){                                                                         \
+        const u64 length = vec_len(v, err);                                                                         \
+        if ( *err != no_err ) return;                                                                               \
+        if ( k > length ){                                                                                          \
+            *err = index_out_of_bounds_err;                                                                         \
+            return;                                                                                                 \
+        }                                                                                                           \
+        if ( k == 0 ) return;                                                                                       \
+        if ( k < length ) vec_nth_element_##T(v, k - 1, cmp, err);                                                  \
+        T* const a = (T*)vec_data_(v, err);                                                                         \
+        if ( a == NULL ) return;                                                                                    \
+        vec_heap_sort_##T(a, k < length ? k - 1 : k, cmp, 0);                                                       \
+    }                                                                                                               \
+    Vector vec_top_k_##T(__restrict const cVector v, const u64 k, const CmpState(*const cmp)(const T, const T),     \
+            vec_err* __restrict const err){                                                                         \
+        const u64 length = vec_len(v, err);                                                                         \
+        if ( *err != no_err ) return NULL;                                                                          \
+        const T* const a = (const T*)vec_cdata_(v, err);                                                            \
+        Vector out = vec_init_(sizeof(T), k, err);                                                                  \
+        if ( out == NULL ) return NULL;                                                                             \
+        for ( u64 i = 0; i < length && k > 0; i++ ){                                                                \
+            const u64 held = vec_len(out, err);                                                                     \
+            if ( held < k ){                                                                                        \
+                vec_push_(out, a + i, err);                                                                         \
+                if ( *err != no_err ) break;                                                                        \
+                vec_heap_sift_up_##T((T*)vec_data_(out, err), held, a[i], cmp, 1, 2);                               \
+                continue;                                                                                           \
+            }                                                                                                       \
+            T* const top = (T*)vec_data_(out, err);                                                                 \
+            if ( cmp(a[i], top[0]) == sup ) vec_heap_sift_down_##T(top, k, 0, a[i], cmp, 1, 2);                     \
+        }                                                                                                           \
+        if ( *err != no_err ){                                                                                      \
+            vec_err ignored;                                                                                        \
+            vec_destroy(out, &ignored);                                                                             \
+            return NULL;                                                                                            \
+        }                                                                                                           \
+        vec_heap_sort_##T((T*)vec_data_(out, err), vec_len(out, err), cmp, 1);                                      \
+        return out;                                                                                                 \
+    }
+
 #define GENERIC_VEC(T)                                                                                              \
     inline Vector vec_init_##T(u64 def_capa, vec_err* __restrict const err){                                        \
         return vec_init_(sizeof(T), def_capa, err);                                                             \
     }                                                                                                               \
+    inline Vector vec_init_aligned_##T(u64 def_capa, u64 alignment, vec_err* __restrict const err){                 \
+        return vec_init_aligned_(sizeof(T), def_capa, alignment, err);                                              \
+    }                                                                                                               \
     inline void   vec_push_##T(Vector v, const T element, vec_err* const err){                                      \
         vec_push_(v, (void*)&(T){element}, err);                                                                    \
     }                                                                                                               \
@@ -124,12 +487,26 @@ void     vec_print_(const __restrict cVector v, void (* const printer )(const vo
         const CmpState inner_function(const void* const a, const void* const b){ return cmp(*(T*)a, *(T*)b);  }     \
         return vec_sort_(v, inner_function, err);                                                                   \
     }                                                                                                               \
+    Vector   vec_stable_sort_##T(__restrict const cVector v,                                                        \
+            const CmpState(*const cmp)(const T, const T),                                                           \
+            vec_err* __restrict const err){                                                                         \
+        const CmpState inner_function(const void* const a, const void* const b){ return cmp(*(T*)a, *(T*)b);  }     \
+        return vec_stable_sort_(v, inner_function, err);                                                            \
+    }                                                                                                               \
+    Vector   vec_argsort_##T(__restrict const cVector v,                                                            \
+            const CmpState(*const cmp)(const T, const T),                                                           \
+            vec_err* __restrict const err){                                                                         \
+        const CmpState inner_function(const void* const a, const void* const b){ return cmp(*(T*)a, *(T*)b);  }     \
+        return vec_argsort(v, inner_function, err);                                                                 \
+    }                                                                                                               \
     void   vec_print_##T(const __restrict cVector v, void (* const printer)(const T)){                        \
         void inner_printer(const void* const x){                                                              \
             printer(*(T*)x);                                                                                    \
         }                                                                                                           \
         vec_print_(v, inner_printer);                                                                               \
-    } 
+    }                                                                                                               \
+    GENERIC_VEC_HEAP(T)                                                                                             \
+    GENERIC_VEC_SELECT(T)
 
 #define GENERIC_VEC_MAPPER(T, U)                                                                                    \
     Vector vec_map_##T##_##U(__restrict const cVector v, const U (* const mapper)(T), vec_err* __restrict const err)\
@@ -142,11 +519,232 @@ void     vec_print_(const __restrict cVector v, void (* const printer )(const vo
         return vec_map_(sizeof(U), v, inner_mapper, err);                                                           \
     }
 
+#define GENERIC_GAP_VEC(T)                                                                                          \
+    inline GapVector gvec_init_##T(u64 def_capa, vec_err* __restrict const err){                                    \
+        return gvec_init_(sizeof(T), def_capa, err);                                                                \
+    }                                                                                                               \
+    inline void   gvec_push_##T(GapVector g, const T element, vec_err* __restrict const err){                       \
+        gvec_push_(g, (void*)&(T){element}, err);                                                                   \
+    }                                                                                                               \
+    inline void   gvec_insert_##T(GapVector g, const T element, const u64 index, vec_err* __restrict const err){    \
+        gvec_insert_(g, (void*)&(T){element}, index, err);                                                          \
+    }                                                                                                               \
+    inline T      gvec_remove_##T(GapVector g, const u64 index, vec_err* __restrict const err){                     \
+        void* input = gvec_remove_(g, index, err);                                                                  \
+        if ( input == NULL ) return (T)0;                                                                           \
+        T output = *(T*)input;                                                                                      \
+        free(input);                                                                                                \
+        return output;                                                                                              \
+    }                                                                                                               \
+    inline T      gvec_get_##T(const __restrict cGapVector g, const u64 index, vec_err* __restrict const err){      \
+        void* input = gvec_get_(g, index, err);                                                                     \
+        if ( input == NULL ) return (T)0;                                                                           \
+        T output = *(T*)input;                                                                                      \
+        free(input);                                                                                                \
+        return output;                                                                                              \
+    }                                                                                                               \
+    void   gvec_foreach_##T(const __restrict cGapVector g, void (* const function)(const T)){                       \
+        void inner_function(const void* const x){                                                                   \
+            function(*(T*)x);                                                                                       \
+        }                                                                                                           \
+        gvec_foreach_(g, inner_function);                                                                           \
+    }
+
+// column level pieces expanded once per field by GENERIC_SOA
+
+#define SOA_ROW_FIELD(S, T, f)          T f;
+#define SOA_COLUMN_FIELD(S, T, f)       Vector f;
+#define SOA_COLUMN_NULL(S, T, f)        s -> f = NULL;
+#define SOA_COLUMN_GET(S, T, f)         row.f = ((const T*)vec_cdata_(s -> f, err))[index];
+#define SOA_COLUMN_TRUNCATE(S, T, f)    vec_truncate(s -> f, s -> length, &ignored);
+
+#define SOA_COLUMN_INIT(S, T, f)                                                                                    \
+    s -> f = vec_init_(sizeof(T), def_capa, err);                                                                   \
+    if ( *err != no_err ) goto soa_init_failure;
+
+#define SOA_COLUMN_DESTROY(S, T, f)                                                                                 \
+    if ( s -> f != NULL ) vec_destroy(s -> f, err);
+
+#define SOA_COLUMN_PUSH(S, T, f)                                                                                    \
+    vec_push_(s -> f, (void*)&row.f, err);                                                                          \
+    if ( *err != no_err ) goto soa_push_failure;
+
+#define SOA_COLUMN_REF(S, T, f)         s -> f,
+
+#define SOA_COLUMN_SORT_BY(S, T, f)                                                                                 \
+    void soa_sort_by_##S##_##f(S##_soa s, const CmpState(*const cmp)(const T, const T), vec_err* __restrict const err){\
+        const CmpState inner_cmp(const void* const a, const void* const b){ return cmp(*(T*)a, *(T*)b); }           \
+        Vector perm = vec_argsort(s -> f, inner_cmp, err);                                                          \
+        if ( *err != no_err ) return;                                                                               \
+        soa_permute_##S(s, perm, err);                                                                              \
+        vec_err ignored;                                                                                            \
+        vec_destroy(perm, &ignored);                                                                                \
+    }
+
+#define SOA_COLUMN_REDUCE(S, T, f)                                                                                  \
+    T      soa_sum_##S##_##f(const S##_soa s, vec_err* __restrict const err){                                       \
+        const T* const column = (const T*)vec_cdata_(s -> f, err);                                                  \
+        if ( column == NULL ) return (T)0;                                                                          \
+        T lanes[8] = { 0 };                                                                                         \
+        u64 i = 0;                                                                                                  \
+        for ( ; i + 8 <= s -> length; i += 8 )                                                                      \
+            for ( u64 l = 0; l < 8; l++ ) lanes[l] += column[i + l];                                                \
+        T acc = 0;                                                                                                  \
+        for ( u64 l = 0; l < 8; l++ ) acc += lanes[l];                                                              \
+        for ( ; i < s -> length; i++ ) acc += column[i];                                                            \
+        return acc;                                                                                                 \
+    }                                                                                                               \
+    T      soa_min_##S##_##f(const S##_soa s, vec_err* __restrict const err){                                       \
+        const T* const column = (const T*)vec_cdata_(s -> f, err);                                                  \
+        if ( column == NULL ) return (T)0;                                                                          \
+        if ( s -> length == 0 ){                                                                                    \
+            *err = illegal_acces_err;                                                                               \
+            return (T)0;                                                                                            \
+        }                                                                                                           \
+        T lanes[8];                                                                                                 \
+        for ( u64 l = 0; l < 8; l++ ) lanes[l] = column[0];                                                         \
+        u64 i = 0;                                                                                                  \
+        for ( ; i + 8 <= s -> length; i += 8 )                                                                      \
+            for ( u64 l = 0; l < 8; l++ ) lanes[l] = column[i + l] < lanes[l] ? column[i + l] : lanes[l];           \
+        T acc = lanes[0];                                                                                           \
+        for ( u64 l = 1; l < 8; l++ ) acc = lanes[l] < acc ? lanes[l] : acc;                                        \
+        for ( ; i < s -> length; i++ ) acc = column[i] < acc ? column[i] : acc;                                     \
+        return acc;                                                                                                 \
+    }                                                                                                               \
+    T      soa_max_##S##_##f(const S##_soa s, vec_err* __restrict const err){                                       \
+        const T* const column = (const T*)vec_cdata_(s -> f, err);                                                  \
+        if ( column == NULL ) return (T)0;                                                                          \
+        if ( s -> length == 0 ){                                                                                    \
+            *err = illegal_acces_err;                                                                               \
+            return (T)0;                                                                                            \
+        }                                                                                                           \
+        T lanes[8];                                                                                                 \
+        for ( u64 l = 0; l < 8; l++ ) lanes[l] = column[0];                                                         \
+        u64 i = 0;                                                                                                  \
+        for ( ; i + 8 <= s -> length; i += 8 )                                                                      \
+            for ( u64 l = 0; l < 8; l++ ) lanes[l] = column[i + l] > lanes[l] ? column[i + l] : lanes[l];           \
+        T acc = lanes[0];                                                                                           \
+        for ( u64 l = 1; l < 8; l++ ) acc = lanes[l] > acc ? lanes[l] : acc;                                        \
+        for ( ; i < s -> length; i++ ) acc = column[i] > acc ? column[i] : acc;                                     \
+        return acc;                                                                                                 \
+    }
+
+#define GENERIC_SOA(S, FIELDS)                                                                                      \
+    typedef struct{ FIELDS(SOA_ROW_FIELD, S) } S##_row;                                                             \
+    typedef struct S##_soa{ FIELDS(SOA_COLUMN_FIELD, S) u64 length; }* S##_soa;                                     \
+    S##_soa soa_init_##S(u64 def_capa, vec_err* __restrict const err){                                              \
+        S##_soa s = (S##_soa)malloc(sizeof(struct S##_soa));                                                        \
+        if ( s == NULL ){                                                                                           \
+            *err = alloc_err;                                                                                       \
+            return NULL;                                                                                            \
+        }                                                                                                           \
+        s -> length = 0;                                                                                            \
+        FIELDS(SOA_COLUMN_NULL, S)                                                                                  \
+        FIELDS(SOA_COLUMN_INIT, S)                                                                                  \
+        return s;                                                                                                   \
+    soa_init_failure:                                                                                               \
+        {                                                                                                           \
+            const vec_err failure = *err;                                                                           \
+            FIELDS(SOA_COLUMN_DESTROY, S)                                                                           \
+            *err = failure;                                                                                         \
+        }                                                                                                           \
+        free(s);                                                                                                    \
+        return NULL;                                                                                                \
+    }                                                                                                               \
+    void   soa_destroy_##S(S##_soa s, vec_err* __restrict const err){                                               \
+        if ( s == NULL ){                                                                                           \
+            *err = null_vec_err;                                                                                    \
+            return;                                                                                                 \
+        }                                                                                                           \
+        FIELDS(SOA_COLUMN_DESTROY, S)                                                                               \
+        free(s);                                                                                                    \
+    }                                                                                                               \
+    u64    soa_len_##S(const S##_soa s, vec_err* __restrict const err){                                             \
+        if ( s == NULL ){                                                                                           \
+            *err = null_vec_err;                                                                                    \
+            return 0;                                                                                               \
+        }                                                                                                           \
+        *err = no_err;                                                                                              \
+        return s -> length;                                                                                         \
+    }                                                                                                               \
+    void   soa_push_##S(S##_soa s, const S##_row row, vec_err* __restrict const err){                               \
+        vec_err ignored;                                                                                            \
+        FIELDS(SOA_COLUMN_PUSH, S)                                                                                  \
+        s -> length ++;                                                                                             \
+        return;                                                                                                     \
+    soa_push_failure:                                                                                               \
+        FIELDS(SOA_COLUMN_TRUNCATE, S)                                                                              \
+    }                                                                                                               \
+    S##_row soa_get_##S(const S##_soa s, const u64 index, vec_err* __restrict const err){                           \
+        S##_row row = { 0 };                                                                                        \
+        if ( s == NULL ){                                                                                           \
+            *err = null_vec_err;                                                                                    \
+            return row;                                                                                             \
+        }                                                                                                           \
+        if ( index >= s -> length ){                                                                                \
+            *err = index_out_of_bounds_err;                                                                         \
+            return row;                                                                                             \
+        }                                                                                                           \
+        FIELDS(SOA_COLUMN_GET, S)                                                                                   \
+        return row;                                                                                                 \
+    }                                                                                                               \
+    void   soa_permute_##S(S##_soa s, __restrict const cVector perm, vec_err* __restrict const err){                \
+        Vector columns[] = { FIELDS(SOA_COLUMN_REF, S) };                                                           \
+        vec_apply_permutation_all(columns, sizeof(columns) / sizeof(*columns), perm, err);                          \
+    }                                                                                                               \
+    FIELDS(SOA_COLUMN_SORT_BY, S)                                                                                   \
+    FIELDS(SOA_COLUMN_REDUCE, S)                                                                                    \
+    S##_soa soa_filter_##S(const S##_soa s, const int (* const predicate)(const S##_row),                           \
+            vec_err* __restrict const err){                                                                         \
+        S##_soa out = soa_init_##S(0, err);                                                                         \
+        if ( out == NULL ) return NULL;                                                                             \
+        for ( u64 i = 0; i < s -> length; i++ ){                                                                    \
+            const S##_row row = soa_get_##S(s, i, err);                                                             \
+            if ( !predicate(row) ) continue;                                                                        \
+            soa_push_##S(out, row, err);                                                                            \
+            if ( *err != no_err ){                                                                                  \
+                vec_err ignored;                                                                                    \
+                soa_destroy_##S(out, &ignored);                                                                     \
+                return NULL;                                                                                        \
+            }                                                                                                       \
+        }                                                                                                           \
+        return out;                                                                                                 \
+    }                                                                                                               \
+    S##_soa soa_from_vec_##S(__restrict const cVector v, vec_err* __restrict const err){                            \
+        const S##_row* const rows = (const S##_row*)vec_cdata_(v, err);                                             \
+        if ( rows == NULL ) return NULL;                                                                            \
+        const u64 n = vec_len(v, err);                                                                              \
+        S##_soa out = soa_init_##S(n, err);                                                                         \
+        if ( out == NULL ) return NULL;                                                                             \
+        for ( u64 i = 0; i < n; i++ ){                                                                              \
+            soa_push_##S(out, rows[i], err);                                                                        \
+            if ( *err != no_err ){                                                                                  \
+                vec_err ignored;                                                                                    \
+                soa_destroy_##S(out, &ignored);                                                                     \
+                return NULL;                                                                                        \
+            }                                                                                                       \
+        }                                                                                                           \
+        return out;                                                                                                 \
+    }                                                                                                               \
+    Vector soa_to_vec_##S(const S##_soa s, vec_err* __restrict const err){                                          \
+        Vector out = vec_init_(sizeof(S##_row), s -> length, err);                                                  \
+        if ( out == NULL ) return NULL;                                                                             \
+        for ( u64 i = 0; i < s -> length; i++ ){                                                                    \
+            const S##_row row = soa_get_##S(s, i, err);                                                             \
+            vec_push_(out, (void*)&row, err);                                                                       \
+            if ( *err != no_err ){                                                                                  \
+                vec_err ignored;                                                                                    \
+                vec_destroy(out, &ignored);                                                                         \
+                return NULL;                                                                                        \
+            }                                                                                                       \
+        }                                                                                                           \
+        return out;                                                                                                 \
+    }
+
 #endif
 
 
 
 //TODO:
 //-filter method
-//-deep copy
 //-more rigorous tests